@@ -0,0 +1,688 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench.c
+ * @brief Standalone benchmark of the host and iCalendar engines.
+ *
+ * Runs a workload for a number of warm-up iterations and then measures every
+ * iteration, printing the mean, percentiles and throughput.  On Linux the
+ * hardware counters of the measured iterations can be collected, too.
+ */
+
+#include "hosts.h"
+#include "ical_utils.h"
+
+#include <getopt.h>
+#include <glib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Fixed reference time, so that runs are comparable.
+ */
+#define BENCH_REFERENCE_TIME 1750000000
+
+/**
+ * @brief Options and inputs of a benchmark run.
+ */
+typedef struct bench_options
+{
+  const char *workload;   ///< Name of the workload.
+  long iterations;        ///< Number of measured iterations.
+  long warmup;            ///< Number of warm-up iterations.
+  int size;               ///< Size of the generated input.
+  int max_hosts;          ///< Maximum number of hosts.
+  int perf;               ///< Whether to collect hardware counters.
+  int json;               ///< Whether to print the results as JSON.
+  char *hosts;            ///< Hosts string.
+  char *exclude;          ///< Excluded hosts string.
+  char *host;             ///< Host to find.
+  char *ical;             ///< iCalendar string.
+  char *zone;             ///< Default timezone.
+  hosts_list_x list;      ///< Parsed hosts for the lookup workloads.
+  hosts_range_x find;     ///< Parsed host to find.
+} bench_options;
+
+/**
+ * @brief A workload, run once per iteration.
+ */
+typedef struct bench_workload
+{
+  const char *name;
+  const char *description;
+  void (*prepare) (bench_options *);
+  long (*run) (bench_options *);
+} bench_workload;
+
+/**
+ * @brief Generate a hosts string with a mix of all syntaxes.
+ *
+ * @param[in]  size  Number of elements.
+ *
+ * @return Newly allocated hosts string.
+ */
+static char *
+generate_hosts (int size)
+{
+  GString *hosts;
+  int index;
+
+  hosts = g_string_new ("");
+  for (index = 0; index < size; index++)
+    {
+      if (index)
+        g_string_append (hosts, ", ");
+      switch (index % 4)
+        {
+          case 0:
+            g_string_append_printf (hosts, "10.%d.%d.0/28",
+                                    index / 256 % 256, index % 256);
+            break;
+          case 1:
+            g_string_append_printf (hosts, "192.168.%d.1-20", index % 256);
+            break;
+          case 2:
+            g_string_append_printf (hosts, "172.16.%d.%d",
+                                    index / 256 % 256, index % 256);
+            break;
+          default:
+            g_string_append_printf (hosts, "host-%d.example.com", index);
+            break;
+        }
+    }
+  return g_string_free (hosts, FALSE);
+}
+
+/**
+ * @brief Generate a daily iCalendar string starting in 2010.
+ *
+ * @param[in]  exdates  Number of EXDATEs.
+ *
+ * @return Newly allocated iCalendar string.
+ */
+static char *
+generate_ical (int exdates)
+{
+  GString *ical;
+  int index;
+
+  ical = g_string_new ("BEGIN:VCALENDAR\n"
+                       "VERSION:2.0\n"
+                       "PRODID:-//Greenbone.net//NONSGML Greenbone Security"
+                       " Manager//EN\n"
+                       "BEGIN:VEVENT\n"
+                       "DTSTART:20100101T030700Z\n"
+                       "DURATION:PT0S\n"
+                       "RRULE:FREQ=DAILY\n");
+  for (index = 0; index < exdates; index++)
+    {
+      GDateTime *date;
+      gchar *formatted;
+
+      date = g_date_time_new_utc (2020, 1, 1, 3, 7, 0);
+      date = g_date_time_add_days (date, index * 3);
+      formatted = g_date_time_format (date, "%Y%m%dT%H%M%SZ");
+      g_string_append_printf (ical, "EXDATE:%s\n", formatted);
+      g_free (formatted);
+      g_date_time_unref (date);
+    }
+  g_string_append (ical,
+                   "UID:8c022087-e10a-462e-a1af-65559601a0db\n"
+                   "END:VEVENT\n"
+                   "END:VCALENDAR\n");
+  return g_string_free (ical, FALSE);
+}
+
+/**
+ * @brief Generate the hosts inputs unless given.
+ *
+ * @param[in,out]  options  The options.
+ */
+static void
+prepare_hosts (bench_options *options)
+{
+  if (options->hosts == NULL)
+    options->hosts = generate_hosts (options->size);
+  if (options->exclude == NULL)
+    options->exclude = g_strdup ("10.0.1.5, 192.168.1.7, host-3.example.com");
+  if (options->host == NULL)
+    options->host = g_strdup_printf ("192.168.%d.10",
+                                     (options->size / 2) | 1);
+}
+
+/**
+ * @brief Parse a target of hostnames and the hostname to find.
+ *
+ * The hostname to find is the last one, in upper case, so that a linear
+ *  search has to compare all names.
+ *
+ * @param[in,out]  options  The options.
+ */
+static void
+prepare_names (bench_options *options)
+{
+  hosts_arena_x arena;
+  hosts_list_x find;
+  size_t size;
+
+  if (options->hosts == NULL)
+    {
+      GString *hosts;
+      int index;
+
+      hosts = g_string_new ("");
+      for (index = 0; index < options->size; index++)
+        g_string_append_printf (hosts, "%shost-%d.example.com",
+                                index ? ", " : "", index);
+      options->hosts = g_string_free (hosts, FALSE);
+    }
+  if (options->host == NULL)
+    options->host = g_strdup_printf ("HOST-%d.EXAMPLE.COM",
+                                     options->size - 1);
+
+  size = hosts_parse_space_x (options->hosts, strlen (options->hosts));
+  hosts_arena_init_x (&arena, g_malloc (size), size);
+  if (hosts_parse_x (options->hosts, strlen (options->hosts), 0, 0, &arena,
+                     &options->list))
+    {
+      fprintf (stderr, "Invalid hosts: %s\n", options->hosts);
+      exit (EXIT_FAILURE);
+    }
+
+  size = hosts_parse_space_x (options->host, strlen (options->host));
+  hosts_arena_init_x (&arena, g_malloc (size), size);
+  if (hosts_parse_x (options->host, strlen (options->host), 1, 0, &arena,
+                     &find)
+      || find.count != 1)
+    {
+      fprintf (stderr, "Invalid host: %s\n", options->host);
+      exit (EXIT_FAILURE);
+    }
+  options->find = find.ranges[0];
+}
+
+/**
+ * @brief Parse the hostnames and sort them for a binary search.
+ *
+ * @param[in,out]  options  The options.
+ */
+static void
+prepare_names_sorted (bench_options *options)
+{
+  prepare_names (options);
+  hosts_list_normalize_x (&options->list);
+}
+
+/**
+ * @brief Generate the iCalendar input unless given.
+ *
+ * @param[in,out]  options  The options.
+ */
+static void
+prepare_ical (bench_options *options)
+{
+  if (options->ical == NULL)
+    options->ical = generate_ical (options->size);
+}
+
+/**
+ * @brief Run hosts_str_contains once.
+ *
+ * @param[in]  options  The options.
+ *
+ * @return The result, to keep the call from being optimized away.
+ */
+static long
+run_hosts_contains (bench_options *options)
+{
+  return hosts_str_contains (options->hosts, options->host,
+                             options->max_hosts);
+}
+
+/**
+ * @brief Run manage_count_hosts_max once.
+ *
+ * @param[in]  options  The options.
+ *
+ * @return The result, to keep the call from being optimized away.
+ */
+static long
+run_max_hosts (bench_options *options)
+{
+  return manage_count_hosts_max (options->hosts, options->exclude,
+                                 options->max_hosts);
+}
+
+/**
+ * @brief Look up the host in the parsed hosts once.
+ *
+ * @param[in]  options  The options.
+ *
+ * @return The result, to keep the call from being optimized away.
+ */
+static long
+run_names (bench_options *options)
+{
+  return hosts_list_contains_x (&options->list, &options->find);
+}
+
+/**
+ * @brief Run icalendar_next_time_from_string_x once.
+ *
+ * @param[in]  options  The options.
+ *
+ * @return The result, to keep the call from being optimized away.
+ */
+static long
+run_next_time_ical (bench_options *options)
+{
+  return icalendar_next_time_from_string_x (options->ical,
+                                            BENCH_REFERENCE_TIME,
+                                            options->zone, 0);
+}
+
+/**
+ * @brief All workloads.
+ */
+static const bench_workload workloads[] = {
+  {"hosts_contains", "hosts_str_contains, SIZE elements in the hosts",
+   prepare_hosts, run_hosts_contains},
+  {"max_hosts", "manage_count_hosts_max, SIZE elements in the hosts",
+   prepare_hosts, run_max_hosts},
+  {"names_linear", "hostname lookup in SIZE unsorted hostnames",
+   prepare_names, run_names},
+  {"names_sorted", "hostname lookup in SIZE sorted hostnames",
+   prepare_names_sorted, run_names},
+  {"next_time_ical", "icalendar_next_time_from_string_x, SIZE EXDATEs",
+   prepare_ical, run_next_time_ical},
+  {NULL, NULL, NULL, NULL}
+};
+
+/**
+ * @brief Get the current time in nanoseconds.
+ *
+ * @return Monotonic time in nanoseconds.
+ */
+static uint64_t
+now_ns (void)
+{
+  struct timespec now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+/**
+ * @brief Compare two durations for qsort.
+ */
+static int
+compare_durations (const void *one, const void *two)
+{
+  uint64_t a = *(const uint64_t *) one;
+  uint64_t b = *(const uint64_t *) two;
+
+  return (a > b) - (a < b);
+}
+
+/**
+ * @brief Get a percentile of sorted durations.
+ *
+ * @param[in]  durations  Sorted durations.
+ * @param[in]  count      Number of durations.
+ * @param[in]  percent    The percentile.
+ *
+ * @return The duration at the percentile.
+ */
+static uint64_t
+percentile (const uint64_t *durations, long count, double percent)
+{
+  long index;
+
+  index = (long) (count * percent / 100.0 + 0.5) - 1;
+  if (index < 0)
+    index = 0;
+  if (index >= count)
+    index = count - 1;
+  return durations[index];
+}
+
+#ifdef __linux__
+/**
+ * @brief Hardware counters collected with perf.
+ */
+static const struct
+{
+  const char *name;
+  uint64_t config;
+} perf_counters[] = {
+  {"cycles", PERF_COUNT_HW_CPU_CYCLES},
+  {"instructions", PERF_COUNT_HW_INSTRUCTIONS},
+  {"cache_misses", PERF_COUNT_HW_CACHE_MISSES},
+  {"branch_misses", PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+#define PERF_COUNTERS (sizeof (perf_counters) / sizeof (perf_counters[0]))
+
+/**
+ * @brief Open the hardware counters as one group.
+ *
+ * @param[out]  fds  File descriptors of the counters.
+ *
+ * @return 0 on success, -1 if the counters are not available.
+ */
+static int
+perf_open (int *fds)
+{
+  size_t index;
+
+  for (index = 0; index < PERF_COUNTERS; index++)
+    {
+      struct perf_event_attr attr;
+
+      memset (&attr, 0, sizeof (attr));
+      attr.size = sizeof (attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = perf_counters[index].config;
+      attr.disabled = index == 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      fds[index] = syscall (SYS_perf_event_open, &attr, 0, -1,
+                            index == 0 ? -1 : fds[0], 0);
+      if (fds[index] < 0)
+        {
+          while (index > 0)
+            close (fds[--index]);
+          return -1;
+        }
+    }
+  return 0;
+}
+
+/**
+ * @brief Read the hardware counters and close them.
+ *
+ * @param[in]   fds     File descriptors of the counters.
+ * @param[out]  values  Values of the counters.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+perf_close (int *fds, uint64_t *values)
+{
+  uint64_t buffer[1 + PERF_COUNTERS];
+  size_t index;
+  int ret = 0;
+
+  ioctl (fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  if (read (fds[0], buffer, sizeof (buffer)) != (ssize_t) sizeof (buffer)
+      || buffer[0] != PERF_COUNTERS)
+    ret = -1;
+  for (index = 0; index < PERF_COUNTERS; index++)
+    {
+      values[index] = ret ? 0 : buffer[1 + index];
+      close (fds[index]);
+    }
+  return ret;
+}
+#endif
+
+/**
+ * @brief Run a workload and print the results.
+ *
+ * @param[in]  workload  The workload.
+ * @param[in]  options   The options.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+bench_run (const bench_workload *workload, bench_options *options)
+{
+  uint64_t *durations, total, start;
+  long index, sink;
+  int perf_enabled = 0;
+#ifdef __linux__
+  int perf_fds[PERF_COUNTERS];
+  uint64_t perf_values[PERF_COUNTERS];
+#endif
+
+  workload->prepare (options);
+
+  durations = g_malloc (sizeof (uint64_t) * options->iterations);
+  sink = 0;
+
+  for (index = 0; index < options->warmup; index++)
+    sink += workload->run (options);
+
+#ifdef __linux__
+  if (options->perf)
+    {
+      if (perf_open (perf_fds) == 0)
+        {
+          perf_enabled = 1;
+          ioctl (perf_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+          ioctl (perf_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+      else
+        fprintf (stderr, "Hardware counters are not available,"
+                         " check kernel.perf_event_paranoid\n");
+    }
+#else
+  if (options->perf)
+    fprintf (stderr, "Hardware counters are only available on Linux\n");
+#endif
+
+  total = 0;
+  for (index = 0; index < options->iterations; index++)
+    {
+      start = now_ns ();
+      sink += workload->run (options);
+      durations[index] = now_ns () - start;
+      total += durations[index];
+    }
+
+#ifdef __linux__
+  if (perf_enabled && perf_close (perf_fds, perf_values))
+    perf_enabled = 0;
+#endif
+
+  qsort (durations, options->iterations, sizeof (uint64_t),
+         compare_durations);
+
+  if (options->json)
+    {
+      printf ("{\"workload\": \"%s\", \"size\": %d, \"iterations\": %ld,"
+              " \"mean_ns\": %.1f, \"p50_ns\": %lu, \"p90_ns\": %lu,"
+              " \"p99_ns\": %lu, \"max_ns\": %lu, \"ops_per_s\": %.1f",
+              workload->name, options->size, options->iterations,
+              (double) total / options->iterations,
+              (unsigned long) percentile (durations, options->iterations, 50),
+              (unsigned long) percentile (durations, options->iterations, 90),
+              (unsigned long) percentile (durations, options->iterations, 99),
+              (unsigned long) durations[options->iterations - 1],
+              total ? options->iterations * 1e9 / total : 0);
+#ifdef __linux__
+      if (perf_enabled)
+        for (index = 0; index < (long) PERF_COUNTERS; index++)
+          printf (", \"%s_per_op\": %.1f", perf_counters[index].name,
+                  (double) perf_values[index] / options->iterations);
+#endif
+      printf ("}\n");
+    }
+  else
+    {
+      printf ("workload:   %s (size %d)\n", workload->name, options->size);
+      printf ("iterations: %ld (warm-up %ld)\n", options->iterations,
+              options->warmup);
+      printf ("mean:       %.1f ns\n", (double) total / options->iterations);
+      printf ("p50:        %lu ns\n",
+              (unsigned long) percentile (durations, options->iterations, 50));
+      printf ("p90:        %lu ns\n",
+              (unsigned long) percentile (durations, options->iterations, 90));
+      printf ("p99:        %lu ns\n",
+              (unsigned long) percentile (durations, options->iterations, 99));
+      printf ("max:        %lu ns\n",
+              (unsigned long) durations[options->iterations - 1]);
+      printf ("throughput: %.1f ops/s\n",
+              total ? options->iterations * 1e9 / total : 0);
+#ifdef __linux__
+      if (perf_enabled)
+        for (index = 0; index < (long) PERF_COUNTERS; index++)
+          printf ("%-12s%.1f per op\n", perf_counters[index].name,
+                  (double) perf_values[index] / options->iterations);
+#endif
+      printf ("result sum: %ld\n", sink);
+    }
+
+  g_free (durations);
+  return 0;
+}
+
+/**
+ * @brief Print the usage.
+ *
+ * @param[in]  program  Name of the program.
+ */
+static void
+usage (const char *program)
+{
+  const bench_workload *workload;
+
+  printf ("Usage: %s [OPTION...] WORKLOAD\n\n", program);
+  printf ("Options:\n"
+          "  -n, --iterations N  Measured iterations (default 10000)\n"
+          "  -w, --warmup N      Warm-up iterations (default 1000)\n"
+          "  -s, --size N        Size of the generated input (default 100)\n"
+          "  -m, --max-hosts N   Maximum number of hosts (default 4095)\n"
+          "  -p, --perf          Collect hardware counters\n"
+          "  -j, --json          Print the results as JSON\n"
+          "      --hosts S       Hosts string instead of a generated one\n"
+          "      --exclude S     Excluded hosts string\n"
+          "      --host S        Host to find\n"
+          "      --ical FILE     iCalendar file instead of a generated one\n"
+          "      --zone S        Default timezone (default UTC)\n"
+          "\nWorkloads:\n");
+  for (workload = workloads; workload->name; workload++)
+    printf ("  %-16s%s\n", workload->name, workload->description);
+}
+
+int
+main (int argc, char **argv)
+{
+  static const struct option long_options[] = {
+    {"iterations", required_argument, NULL, 'n'},
+    {"warmup", required_argument, NULL, 'w'},
+    {"size", required_argument, NULL, 's'},
+    {"max-hosts", required_argument, NULL, 'm'},
+    {"perf", no_argument, NULL, 'p'},
+    {"json", no_argument, NULL, 'j'},
+    {"hosts", required_argument, NULL, 'H'},
+    {"exclude", required_argument, NULL, 'E'},
+    {"host", required_argument, NULL, 'F'},
+    {"ical", required_argument, NULL, 'I'},
+    {"zone", required_argument, NULL, 'Z'},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0}
+  };
+  const bench_workload *workload;
+  bench_options options;
+  int option;
+
+  memset (&options, 0, sizeof (options));
+  options.iterations = 10000;
+  options.warmup = 1000;
+  options.size = 100;
+  options.max_hosts = 4095;
+  options.zone = "UTC";
+
+  while ((option = getopt_long (argc, argv, "n:w:s:m:pjh", long_options,
+                                NULL))
+         != -1)
+    switch (option)
+      {
+        case 'n':
+          options.iterations = atol (optarg);
+          break;
+        case 'w':
+          options.warmup = atol (optarg);
+          break;
+        case 's':
+          options.size = atoi (optarg);
+          break;
+        case 'm':
+          options.max_hosts = atoi (optarg);
+          break;
+        case 'p':
+          options.perf = 1;
+          break;
+        case 'j':
+          options.json = 1;
+          break;
+        case 'H':
+          options.hosts = g_strdup (optarg);
+          break;
+        case 'E':
+          options.exclude = g_strdup (optarg);
+          break;
+        case 'F':
+          options.host = g_strdup (optarg);
+          break;
+        case 'I':
+          if (g_file_get_contents (optarg, &options.ical, NULL, NULL)
+              == FALSE)
+            {
+              fprintf (stderr, "Could not read %s\n", optarg);
+              return EXIT_FAILURE;
+            }
+          break;
+        case 'Z':
+          options.zone = optarg;
+          break;
+        case 'h':
+          usage (argv[0]);
+          return EXIT_SUCCESS;
+        default:
+          usage (argv[0]);
+          return EXIT_FAILURE;
+      }
+
+  if (optind != argc - 1 || options.iterations < 1 || options.warmup < 0)
+    {
+      usage (argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  for (workload = workloads; workload->name; workload++)
+    if (strcmp (workload->name, argv[optind]) == 0)
+      return bench_run (workload, &options) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+  fprintf (stderr, "Unknown workload: %s\n", argv[optind]);
+  usage (argv[0]);
+  return EXIT_FAILURE;
+}
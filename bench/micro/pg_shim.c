@@ -0,0 +1,277 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pg_shim.c
+ * @brief Minimal replacements of PostgreSQL server functions.
+ *
+ * Allows running the host and iCalendar engines outside of the server.
+ * Memory is taken from malloc and errors are printed to stderr, errors of
+ * level ERROR and above terminate the program.
+ */
+
+#include "postgres.h"
+#include "miscadmin.h"
+
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Never set, there is no one to interrupt the benchmark.
+ */
+volatile sig_atomic_t InterruptPending = false;
+
+/**
+ * @brief There are no memory contexts, memory is freed explicitly.
+ */
+MemoryContext CurrentMemoryContext = NULL;
+
+/**
+ * @brief Level of the error being reported.
+ */
+static int shim_elevel = 0;
+
+/**
+ * @brief Message of the error being reported.
+ */
+static char shim_message[1024];
+
+/**
+ * @brief Allocate memory, terminating on failure.
+ *
+ * @param[in]  size  Number of bytes.
+ *
+ * @return The memory.
+ */
+void *
+palloc (Size size)
+{
+  void *ret;
+
+  ret = malloc (size ? size : 1);
+  if (ret == NULL)
+    {
+      fprintf (stderr, "out of memory\n");
+      exit (EXIT_FAILURE);
+    }
+  return ret;
+}
+
+/**
+ * @brief Allocate zeroed memory, terminating on failure.
+ *
+ * @param[in]  size  Number of bytes.
+ *
+ * @return The memory.
+ */
+void *
+palloc0 (Size size)
+{
+  void *ret;
+
+  ret = palloc (size);
+  memset (ret, 0, size);
+  return ret;
+}
+
+/**
+ * @brief Change the size of memory, terminating on failure.
+ *
+ * @param[in]  pointer  The memory.
+ * @param[in]  size     New number of bytes.
+ *
+ * @return The memory.
+ */
+void *
+repalloc (void *pointer, Size size)
+{
+  void *ret;
+
+  ret = realloc (pointer, size ? size : 1);
+  if (ret == NULL)
+    {
+      fprintf (stderr, "out of memory\n");
+      exit (EXIT_FAILURE);
+    }
+  return ret;
+}
+
+/**
+ * @brief Free memory.
+ *
+ * @param[in]  pointer  The memory.
+ */
+void
+pfree (void *pointer)
+{
+  free (pointer);
+}
+
+/**
+ * @brief Ignore a reset callback, as memory contexts are never reset.
+ *
+ * @param[in]  context  The memory context.
+ * @param[in]  cb       The callback.
+ */
+void
+MemoryContextRegisterResetCallback (MemoryContext context,
+                                    MemoryContextCallback *cb)
+{
+  (void) context;
+  (void) cb;
+}
+
+/**
+ * @brief Nothing to process, interrupts are never pending.
+ */
+void
+ProcessInterrupts (void)
+{
+}
+
+/**
+ * @brief Start reporting an error.
+ *
+ * @param[in]  elevel  Level of the error.
+ * @param[in]  domain  Message domain, ignored.
+ *
+ * @return Whether the error is reported, only for warnings and above.
+ */
+bool
+errstart (int elevel, const char *domain)
+{
+  (void) domain;
+
+  if (elevel < WARNING)
+    return false;
+
+  shim_elevel = elevel;
+  shim_message[0] = '\0';
+  return true;
+}
+
+/**
+ * @brief Start reporting an error of level ERROR or above.
+ *
+ * @param[in]  elevel  Level of the error.
+ * @param[in]  domain  Message domain, ignored.
+ *
+ * @return Always true.
+ */
+bool
+errstart_cold (int elevel, const char *domain)
+{
+  return errstart (elevel, domain);
+}
+
+/**
+ * @brief Finish reporting an error.
+ *
+ * @param[in]  filename  Source file of the error.
+ * @param[in]  lineno    Source line of the error.
+ * @param[in]  funcname  Function of the error.
+ */
+void
+errfinish (const char *filename, int lineno, const char *funcname)
+{
+  fprintf (stderr, "%s: %s (%s:%d in %s)\n",
+           shim_elevel >= ERROR ? "ERROR" : "WARNING", shim_message,
+           filename, lineno, funcname ? funcname : "?");
+  if (shim_elevel >= ERROR)
+    exit (EXIT_FAILURE);
+}
+
+/**
+ * @brief Set the SQLSTATE of an error, ignored.
+ *
+ * @param[in]  sqlerrcode  The SQLSTATE.
+ *
+ * @return Always 0.
+ */
+int
+errcode (int sqlerrcode)
+{
+  (void) sqlerrcode;
+  return 0;
+}
+
+/**
+ * @brief Set the message of an error.
+ *
+ * @param[in]  fmt  Format of the message.
+ *
+ * @return Always 0.
+ */
+int
+errmsg (const char *fmt, ...)
+{
+  va_list args;
+
+  va_start (args, fmt);
+  vsnprintf (shim_message, sizeof (shim_message), fmt, args);
+  va_end (args);
+  return 0;
+}
+
+/**
+ * @brief Set the message of an internal error.
+ *
+ * @param[in]  fmt  Format of the message.
+ *
+ * @return Always 0.
+ */
+int
+errmsg_internal (const char *fmt, ...)
+{
+  va_list args;
+
+  va_start (args, fmt);
+  vsnprintf (shim_message, sizeof (shim_message), fmt, args);
+  va_end (args);
+  return 0;
+}
+
+/**
+ * @brief Set the detail of an error, ignored.
+ *
+ * @param[in]  fmt  Format of the detail.
+ *
+ * @return Always 0.
+ */
+int
+errdetail (const char *fmt, ...)
+{
+  (void) fmt;
+  return 0;
+}
+
+/**
+ * @brief Set the hint of an error, ignored.
+ *
+ * @param[in]  fmt  Format of the hint.
+ *
+ * @return Always 0.
+ */
+int
+errhint (const char *fmt, ...)
+{
+  (void) fmt;
+  return 0;
+}
@@ -0,0 +1,83 @@
+#!/bin/sh
+# Copyright (C) 2026 Greenbone AG
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#
+# Compare benchmark results written by run.sh against a stored baseline.
+# Exits with status 1 if the throughput of any run dropped or its p95 latency
+# rose by more than the threshold.
+#
+
+set -eu
+
+if [ $# -lt 2 ]; then
+  echo "Usage: $0 BASELINE RESULTS [THRESHOLD_PERCENT]" >&2
+  exit 1
+fi
+
+BASELINE="$1"
+RESULTS="$2"
+THRESHOLD="${3:-10}"
+
+if [ ! -f "$BASELINE" ]; then
+  echo "No baseline at $BASELINE, nothing to compare."
+  echo "Store the current results as baseline with the benchmark-baseline"
+  echo "target or by copying $RESULTS."
+  exit 0
+fi
+
+awk -v threshold="$THRESHOLD" '
+  function field(line, key,    value) {
+    if (match (line, "\"" key "\": \"?[^,}\"]*") == 0)
+      return ""
+    value = substr (line, RSTART, RLENGTH)
+    sub (/^[^:]*: "?/, "", value)
+    return value
+  }
+  {
+    key = field($0, "function") "/" field($0, "clients")
+  }
+  FNR == NR {
+    baseline_tps[key] = field($0, "tps")
+    baseline_p95[key] = field($0, "latency_p95_ms")
+    next
+  }
+  {
+    tps = field($0, "tps")
+    p95 = field($0, "latency_p95_ms")
+    if (!(key in baseline_tps)) {
+      printf "%-24s %12.3f tps %10.3f ms p95 (no baseline)\n", key, tps, p95
+      next
+    }
+    tps_change = baseline_tps[key] > 0 \
+                 ? (tps - baseline_tps[key]) * 100 / baseline_tps[key] : 0
+    p95_change = baseline_p95[key] > 0 \
+                 ? (p95 - baseline_p95[key]) * 100 / baseline_p95[key] : 0
+    status = "ok"
+    if (tps_change < -threshold || p95_change > threshold) {
+      status = "REGRESSION"
+      regressions++
+    }
+    printf "%-24s %12.3f tps (%+6.1f%%) %10.3f ms p95 (%+6.1f%%) %s\n",
+           key, tps, tps_change, p95, p95_change, status
+  }
+  END {
+    if (regressions > 0) {
+      printf "%d run(s) regressed by more than %s%%\n", regressions, threshold
+      exit 1
+    }
+  }' "$BASELINE" "$RESULTS"
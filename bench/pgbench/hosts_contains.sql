@@ -0,0 +1,6 @@
+-- Check 100 result hosts against a random target.
+\set target random(1, 5000)
+\set host random(1, 9901)
+SELECT count (*) FILTER (WHERE hosts_contains (t.hosts, h.host))
+  FROM pg_gvm_bench.targets t, pg_gvm_bench.result_hosts h
+  WHERE t.id = :target AND h.id BETWEEN :host AND :host + 99;
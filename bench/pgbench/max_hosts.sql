@@ -0,0 +1,5 @@
+-- Count the hosts of 100 consecutive targets.
+\set target random(1, 4901)
+SELECT sum (max_hosts (hosts, exclude_hosts))
+  FROM pg_gvm_bench.targets
+  WHERE id BETWEEN :target AND :target + 99;
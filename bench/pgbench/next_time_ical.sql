@@ -0,0 +1,6 @@
+-- Get the next times of 10 consecutive schedules at a random reference time.
+\set schedule random(1, 1991)
+\set reference random(1600000000, 1900000000)
+SELECT max (next_time_ical (icalendar, :reference, timezone))
+  FROM pg_gvm_bench.schedules
+  WHERE id BETWEEN :schedule AND :schedule + 9;
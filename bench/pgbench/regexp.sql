@@ -0,0 +1,6 @@
+-- Match 100 result descriptions against a random filter expression.
+\set filter random(1, 8)
+\set result random(1, 9901)
+SELECT count (*) FILTER (WHERE regexp (r.description, f.pattern))
+  FROM pg_gvm_bench.results r, pg_gvm_bench.filters f
+  WHERE f.id = :filter AND r.id BETWEEN :result AND :result + 99;
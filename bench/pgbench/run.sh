@@ -0,0 +1,122 @@
+#!/bin/sh
+# Copyright (C) 2026 Greenbone AG
+#
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#
+# Run the pgbench scripts of all functions at several numbers of clients and
+# write the results as JSON lines, one line per function and client count.
+#
+
+set -eu
+
+SCRIPT_DIR=$(cd "$(dirname "$0")" && pwd)
+
+DATABASE="gvmd"
+CLIENTS="1 4 16"
+DURATION=30
+OUTPUT="benchmark-results.jsonl"
+FUNCTIONS="hosts_contains max_hosts regexp next_time_ical"
+SETUP=1
+
+usage() {
+  echo "Usage: $0 [-d database] [-c clients] [-T seconds] [-f functions]"
+  echo "          [-o output] [-s]"
+  echo
+  echo "  -d  Database with the pg-gvm extension (default: $DATABASE)"
+  echo "  -c  Space separated numbers of clients (default: $CLIENTS)"
+  echo "  -T  Duration of each run in seconds (default: $DURATION)"
+  echo "  -f  Space separated functions (default: $FUNCTIONS)"
+  echo "  -o  File to write the results to (default: $OUTPUT)"
+  echo "  -s  Skip generating the data"
+}
+
+while getopts "d:c:T:f:o:sh" opt; do
+  case "$opt" in
+    d) DATABASE="$OPTARG" ;;
+    c) CLIENTS="$OPTARG" ;;
+    T) DURATION="$OPTARG" ;;
+    f) FUNCTIONS="$OPTARG" ;;
+    o) OUTPUT="$OPTARG" ;;
+    s) SETUP=0 ;;
+    h) usage; exit 0 ;;
+    *) usage >&2; exit 1 ;;
+  esac
+done
+
+LOG_DIR=$(mktemp -d)
+trap 'rm -rf "$LOG_DIR"' EXIT
+
+if [ "$SETUP" = 1 ]; then
+  echo "Generating data in $DATABASE"
+  psql -X -q -v ON_ERROR_STOP=1 -d "$DATABASE" -f "$SCRIPT_DIR/setup.sql" \
+    > /dev/null
+fi
+
+: > "$OUTPUT"
+
+for function in $FUNCTIONS; do
+  for clients in $CLIENTS; do
+    echo "Running $function with $clients client(s) for $DURATION s"
+    rm -f "$LOG_DIR"/*
+
+    if ! pgbench -n -P "$DURATION" -T "$DURATION" \
+         -c "$clients" -j "$clients" \
+         -l --log-prefix="$LOG_DIR/log" \
+         -f "$SCRIPT_DIR/$function.sql" "$DATABASE" \
+         > "$LOG_DIR/summary" 2>&1; then
+      cat "$LOG_DIR/summary" >&2
+      exit 1
+    fi
+
+    # The third field of the transaction logs is the latency in microseconds.
+    cat "$LOG_DIR"/log.* | awk '{ print $3 }' | sort -n \
+      > "$LOG_DIR/latencies"
+
+    awk -v name="$function" -v clients="$clients" -v duration="$DURATION" \
+        -v latencies="$LOG_DIR/latencies" '
+      function percentile(p,    index_) {
+        if (count == 0)
+          return 0
+        index_ = int (count * p / 100 + 0.5)
+        if (index_ < 1)
+          index_ = 1
+        return values[index_] / 1000
+      }
+      /^number of transactions actually processed:/ {
+        transactions = $NF
+        sub (/\/.*/, "", transactions)
+      }
+      /^latency average = / { latency_avg = $4 }
+      /^latency stddev = / { latency_stddev = $4 }
+      /^tps = / && /(without|excluding)/ { tps = $3 }
+      END {
+        count = 0
+        while ((getline line < latencies) > 0)
+          values[++count] = line
+        printf "{\"function\": \"%s\", \"clients\": %d, \"duration\": %d,",
+               name, clients, duration
+        printf " \"transactions\": %d, \"tps\": %.3f,", transactions, tps
+        printf " \"latency_avg_ms\": %.3f, \"latency_stddev_ms\": %.3f,",
+               latency_avg, latency_stddev
+        printf " \"latency_p50_ms\": %.3f, \"latency_p95_ms\": %.3f,",
+               percentile(50), percentile(95)
+        printf " \"latency_p99_ms\": %.3f}\n", percentile(99)
+      }' "$LOG_DIR/summary" >> "$OUTPUT"
+  done
+done
+
+echo "Results written to $OUTPUT"
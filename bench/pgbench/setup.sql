@@ -0,0 +1,160 @@
+-- Copyright (C) 2026 Greenbone AG
+--
+-- SPDX-License-Identifier: GPL-3.0-or-later
+--
+-- Generate the data for the pgbench scripts.
+--
+-- The data is generated deterministically, so that results of different runs
+-- can be compared.
+
+DROP SCHEMA IF EXISTS pg_gvm_bench CASCADE;
+CREATE SCHEMA pg_gvm_bench;
+
+SELECT setseed (0.42);
+
+-- Targets with a mix of CIDR blocks, long and short ranges, hostnames and
+-- IPv6 addresses, a third of them with excluded hosts.
+CREATE TABLE pg_gvm_bench.targets
+  (id integer PRIMARY KEY,
+   hosts text NOT NULL,
+   exclude_hosts text NOT NULL);
+
+INSERT INTO pg_gvm_bench.targets
+  SELECT i,
+         CASE i % 5
+           WHEN 0 THEN
+             format ('10.%s.%s.0/24', i / 256 % 256, i % 256)
+           WHEN 1 THEN
+             format ('192.168.%s.1-192.168.%s.200', i % 256, i % 256)
+           WHEN 2 THEN
+             format ('172.16.%s.1-100, 172.17.%s.10-50', i % 256, i % 256)
+           WHEN 3 THEN
+             (SELECT string_agg (format ('host-%s-%s.example.com', i, n),
+                                 ', ')
+              FROM generate_series (1, 20 + i % 80) AS n)
+           ELSE
+             format ('10.%s.%s.0/28, 10.%s.%s.100-10.%s.%s.120,'
+                     || ' srv-%s.example.org, 2001:db8::%s',
+                     i / 256 % 256, i % 256, i / 256 % 256, i % 256,
+                     i / 256 % 256, i % 256, i, to_hex (i))
+         END,
+         CASE
+           WHEN i % 3 = 0 THEN
+             format ('10.%s.%s.5, 192.168.%s.7, 172.16.%s.3',
+                     i / 256 % 256, i % 256, i % 256, i % 256)
+           ELSE ''
+         END
+  FROM generate_series (1, 5000) AS i;
+
+-- Hosts of results, most of them inside of the targets.
+CREATE TABLE pg_gvm_bench.result_hosts
+  (id integer PRIMARY KEY,
+   host text NOT NULL);
+
+INSERT INTO pg_gvm_bench.result_hosts
+  SELECT i,
+         CASE i % 4
+           WHEN 0 THEN
+             format ('10.%s.%s.%s', i / 256 % 256, i % 256,
+                     (random () * 254)::integer + 1)
+           WHEN 1 THEN
+             format ('192.168.%s.%s', i % 256, (random () * 254)::integer + 1)
+           WHEN 2 THEN
+             format ('host-%s-%s.example.com', i % 5000 + 1,
+                     (random () * 99)::integer + 1)
+           ELSE
+             format ('2001:db8::%s', to_hex (i % 5000 + 1))
+         END
+  FROM generate_series (1, 10000) AS i;
+
+-- Schedules with long-lived recurrence rules, many of them with EXDATEs.
+CREATE TABLE pg_gvm_bench.schedules
+  (id integer PRIMARY KEY,
+   icalendar text NOT NULL,
+   timezone text NOT NULL);
+
+INSERT INTO pg_gvm_bench.schedules
+  SELECT i,
+         'BEGIN:VCALENDAR' || E'\n'
+         || 'VERSION:2.0' || E'\n'
+         || 'PRODID:-//Greenbone.net//NONSGML Greenbone Security Manager//EN'
+         || E'\n'
+         || 'BEGIN:VEVENT' || E'\n'
+         || format ('DTSTART:%sT%s0000Z',
+                    to_char (date '2010-01-01' + i % 365, 'YYYYMMDD'),
+                    lpad ((i % 24)::text, 2, '0'))
+         || E'\n'
+         || 'DURATION:PT1H' || E'\n'
+         || 'RRULE:'
+         || CASE i % 6
+              WHEN 0 THEN 'FREQ=DAILY'
+              WHEN 1 THEN 'FREQ=WEEKLY;BYDAY=MO,WE,FR'
+              WHEN 2 THEN 'FREQ=MONTHLY;BYMONTHDAY=1,15'
+              WHEN 3 THEN 'FREQ=HOURLY;INTERVAL=6'
+              WHEN 4 THEN 'FREQ=DAILY;UNTIL=20400101T000000Z'
+              ELSE 'FREQ=YEARLY;BYMONTH=1,7;BYDAY=1MO'
+            END
+         || E'\n'
+         || CASE
+              WHEN i % 2 = 0 THEN
+                (SELECT string_agg (format ('EXDATE:%sT%s0000Z',
+                                            to_char (date '2020-01-01'
+                                                     + n * 7 + i % 7,
+                                                     'YYYYMMDD'),
+                                            lpad ((i % 24)::text, 2, '0')),
+                                    E'\n')
+                 FROM generate_series (0, 20 + i % 100) AS n)
+                || E'\n'
+              ELSE ''
+            END
+         || format ('UID:%s', md5 (i::text)) || E'\n'
+         || 'END:VEVENT' || E'\n'
+         || 'END:VCALENDAR',
+         CASE i % 3
+           WHEN 0 THEN 'UTC'
+           WHEN 1 THEN 'Europe/Berlin'
+           ELSE 'America/New_York'
+         END
+  FROM generate_series (1, 2000) AS i;
+
+-- Typical filter expressions and texts to match them against.
+CREATE TABLE pg_gvm_bench.filters
+  (id integer PRIMARY KEY,
+   pattern text NOT NULL);
+
+INSERT INTO pg_gvm_bench.filters
+  VALUES (1, '^192\.168\.'),
+         (2, 'CVE-20[0-9]{2}-[0-9]{4,}'),
+         (3, '(?i)openssl'),
+         (4, 'ssh|telnet|ftp'),
+         (5, '^$'),
+         (6, '[0-9]+\.[0-9]+\.[0-9]+'),
+         (7, '(?i)^(high|medium|low)$'),
+         (8, 'apache.*2\.4\.[0-9]+');
+
+CREATE TABLE pg_gvm_bench.results
+  (id integer PRIMARY KEY,
+   description text NOT NULL);
+
+INSERT INTO pg_gvm_bench.results
+  SELECT i,
+         CASE i % 5
+           WHEN 0 THEN
+             format ('The remote host 192.168.%s.%s is affected by'
+                     || ' CVE-20%s-%s in OpenSSL %s.%s.%s.',
+                     i % 256, i % 200, 10 + i % 15, 1000 + i,
+                     1, i % 2, i % 20)
+           WHEN 1 THEN
+             format ('Service ssh running on port %s.', 20 + i % 1000)
+           WHEN 2 THEN
+             format ('Apache httpd 2.4.%s detected.', i % 60)
+           WHEN 3 THEN 'Medium'
+           ELSE repeat (md5 (i::text), 1 + i % 10)
+         END
+  FROM generate_series (1, 10000) AS i;
+
+ANALYZE pg_gvm_bench.targets;
+ANALYZE pg_gvm_bench.result_hosts;
+ANALYZE pg_gvm_bench.schedules;
+ANALYZE pg_gvm_bench.filters;
+ANALYZE pg_gvm_bench.results;
@@ -0,0 +1,281 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file hosts_fuzz.c
+ * @brief Fuzz test of the host parser against the parser of libgvm.
+ *
+ * Every input is counted and searched with the parser of the extension and
+ * with libgvm, and the program aborts if the results differ.  Built with
+ * clang the input comes from libFuzzer, otherwise random hosts strings are
+ * generated from addresses, ranges, CIDR blocks and hostnames.
+ *
+ * An input is split at tabs into the hosts, the excluded hosts and the host
+ * to find.
+ */
+
+#include "hosts.h"
+
+#include <glib.h>
+#include <gvm/base/hosts.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Maximum number of hosts, so that libgvm expands little.
+ */
+#define FUZZ_MAX_HOSTS 4096
+
+/**
+ * @brief Longest input that is tested.
+ */
+#define FUZZ_INPUT_MAX 4096
+
+/**
+ * @brief Count hosts with libgvm, like manage_count_hosts_max used to.
+ *
+ * @param[in]  given_hosts    String describing hosts.
+ * @param[in]  exclude_hosts  String describing hosts excluded from given set.
+ * @param[in]  max_hosts      Max hosts.
+ *
+ * @return Number of hosts, or -1 on error.
+ */
+static int
+reference_count_hosts (const char *given_hosts, const char *exclude_hosts,
+                       int max_hosts)
+{
+  gvm_hosts_t *hosts;
+  int count;
+
+  hosts = gvm_hosts_new_with_max (given_hosts, max_hosts);
+  if (hosts == NULL)
+    return -1;
+
+  if (exclude_hosts
+      && gvm_hosts_exclude_with_max (hosts, exclude_hosts, max_hosts) < 0)
+    {
+      gvm_hosts_free (hosts);
+      return -1;
+    }
+
+  count = gvm_hosts_count (hosts);
+  gvm_hosts_free (hosts);
+  return count;
+}
+
+/**
+ * @brief Find a host with libgvm, like hosts_str_contains used to.
+ *
+ * @param[in]  hosts_str      Hosts string to check.
+ * @param[in]  find_host_str  The host to find.
+ * @param[in]  max_hosts      Maximum number of hosts allowed in hosts_str.
+ *
+ * @return 1 if host has equal in hosts_str, 0 otherwise.
+ */
+static int
+reference_contains (const char *hosts_str, const char *find_host_str,
+                    int max_hosts)
+{
+  gvm_hosts_t *hosts, *find_hosts;
+  int ret;
+
+  hosts = gvm_hosts_new_with_max (hosts_str, max_hosts);
+  if (hosts == NULL)
+    return 0;
+
+  find_hosts = gvm_hosts_new_with_max (find_host_str, 1);
+  if (find_hosts == NULL || find_hosts->count != 1)
+    ret = 0;
+  else
+    ret = gvm_host_in_hosts (find_hosts->hosts[0], NULL, hosts);
+
+  gvm_hosts_free (find_hosts);
+  gvm_hosts_free (hosts);
+  return ret;
+}
+
+/**
+ * @brief Compare both parsers on an input, aborting on a difference.
+ *
+ * @param[in]  data  The input.
+ * @param[in]  size  Size of the input.
+ */
+static void
+fuzz_compare (const uint8_t *data, size_t size)
+{
+  char *input, *hosts, *exclude, *find;
+  int count, expected;
+
+  if (size > FUZZ_INPUT_MAX || memchr (data, '\0', size))
+    return;
+
+  input = g_strndup ((const char *) data, size);
+  hosts = input;
+  exclude = strchr (hosts, '\t');
+  find = "192.168.0.1";
+  if (exclude)
+    {
+      *exclude++ = '\0';
+      if (strchr (exclude, '\t'))
+        {
+          find = strchr (exclude, '\t');
+          *find++ = '\0';
+        }
+    }
+
+  count = manage_count_hosts_max (hosts, exclude, FUZZ_MAX_HOSTS);
+  expected = reference_count_hosts (hosts, exclude, FUZZ_MAX_HOSTS);
+  if (count != expected)
+    {
+      fprintf (stderr, "count of \"%s\" excluding \"%s\": %d, libgvm %d\n",
+               hosts, exclude ? exclude : "", count, expected);
+      abort ();
+    }
+
+  count = hosts_str_contains (hosts, find, FUZZ_MAX_HOSTS);
+  expected = reference_contains (hosts, find, FUZZ_MAX_HOSTS);
+  if (count != expected)
+    {
+      fprintf (stderr, "\"%s\" in \"%s\": %d, libgvm %d\n",
+               find, hosts, count, expected);
+      abort ();
+    }
+
+  g_free (input);
+}
+
+/**
+ * @brief Entry point for libFuzzer.
+ *
+ * @param[in]  data  The input.
+ * @param[in]  size  Size of the input.
+ *
+ * @return Always 0.
+ */
+int
+LLVMFuzzerTestOneInput (const uint8_t *data, size_t size)
+{
+  fuzz_compare (data, size);
+  return 0;
+}
+
+#ifndef HOSTS_FUZZ_LIBFUZZER
+
+/**
+ * @brief Append a random hosts element to a string.
+ *
+ * The addresses are taken from small networks, so that ranges overlap.
+ *
+ * @param[in]  string  The string.
+ */
+static void
+fuzz_append_element (GString *string)
+{
+  static const char *names[] = {"localhost", "Example.com", "example.com",
+                                "a-b_c.test", "1host", "-bad", "bad!",
+                                "192.168.0", " "};
+  static const char *separators[] = {", ", ",", "\n", ",,", " , "};
+  int first, last;
+
+  if (string->len)
+    g_string_append (string,
+                     separators[g_random_int_range (0, G_N_ELEMENTS
+                                                             (separators))]);
+
+  first = g_random_int_range (0, 256);
+  last = g_random_int_range (0, 256);
+  switch (g_random_int_range (0, 9))
+    {
+      case 0:
+        g_string_append_printf (string, "192.168.0.%d", first);
+        break;
+      case 1:
+        g_string_append_printf (string, "192.168.0.%d-%d", first, last);
+        break;
+      case 2:
+        g_string_append_printf (string, "192.168.0.%d-192.168.%d.%d", first,
+                                g_random_int_range (0, 2), last);
+        break;
+      case 3:
+        g_string_append_printf (string, "192.168.%d.%d/%d",
+                                g_random_int_range (0, 2), first,
+                                g_random_int_range (20, 34));
+        break;
+      case 4:
+        g_string_append_printf (string, "2001:db8::%x", first);
+        break;
+      case 5:
+        g_string_append_printf (string, "2001:db8::%x-%x", first, last);
+        break;
+      case 6:
+        g_string_append_printf (string, "2001:db8::%x/%d", first,
+                                g_random_int_range (118, 130));
+        break;
+      case 7:
+        g_string_append_printf (string, "2001:db8::%x-2001:db8::%x", first,
+                                last);
+        break;
+      default:
+        g_string_append (string,
+                         names[g_random_int_range (0, G_N_ELEMENTS (names))]);
+        break;
+    }
+}
+
+/**
+ * @brief Compare both parsers on random inputs.
+ *
+ * @param[in]  argc  Number of arguments.
+ * @param[in]  argv  The number of inputs and the seed, both optional.
+ *
+ * @return 0 if no difference was found.
+ */
+int
+main (int argc, char **argv)
+{
+  long iterations, iteration;
+
+  iterations = argc > 1 ? atol (argv[1]) : 100000;
+  if (argc > 2)
+    g_random_set_seed (atoi (argv[2]));
+
+  for (iteration = 0; iteration < iterations; iteration++)
+    {
+      GString *input;
+      int elements;
+
+      input = g_string_new (NULL);
+      for (elements = g_random_int_range (1, 6); elements; elements--)
+        fuzz_append_element (input);
+      g_string_append_c (input, '\t');
+      for (elements = g_random_int_range (0, 4); elements; elements--)
+        fuzz_append_element (input);
+      g_string_append_printf (input, "\t192.168.0.%d",
+                              g_random_int_range (0, 256));
+
+      fuzz_compare ((const uint8_t *) input->str, input->len);
+      g_string_free (input, TRUE);
+    }
+
+  printf ("%ld inputs without differences\n", iterations);
+  return 0;
+}
+
+#endif /* not HOSTS_FUZZ_LIBFUZZER */
@@ -0,0 +1,44 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file host_cache.h
+ * @brief Headers for the shared host count cache
+ */
+
+#ifndef _GVMD_HOST_CACHE_X_H
+#define _GVMD_HOST_CACHE_X_H
+
+#include <stddef.h>
+
+void
+host_cache_define_gucs_x (void);
+
+void
+host_cache_shmem_request_x (void);
+
+void
+host_cache_shmem_startup_x (void);
+
+int
+host_cache_lookup_x (const char *, size_t, const char *, size_t, int, int *);
+
+void
+host_cache_store_x (const char *, size_t, const char *, size_t, int, int);
+
+#endif
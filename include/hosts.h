@@ -23,9 +23,133 @@
 #ifndef _GVMD_HOSTS_X
 #define _GVMD_HOSTS_X
 
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief The hosts string is invalid.
+ */
+#define HOSTS_PARSE_INVALID_X -1
+
+/**
+ * @brief The hosts string has more hosts than allowed.
+ */
+#define HOSTS_PARSE_TOO_MANY_X -2
+
+/**
+ * @brief The arena is too small for the ranges.
+ */
+#define HOSTS_PARSE_NO_SPACE_X -3
+
+/**
+ * @brief The hosts string has more ranges than allowed.
+ */
+#define HOSTS_PARSE_TOO_MANY_RANGES_X -4
+
+/**
+ * @brief Type of a host range.
+ */
+typedef enum
+{
+  HOSTS_RANGE_IPV4_X,
+  HOSTS_RANGE_IPV6_X,
+  HOSTS_RANGE_NAME_X
+} hosts_range_type_x;
+
+/**
+ * @brief An IPv4 or IPv6 address as a 128 bit number.
+ *
+ * IPv4 addresses only use the lower 32 bits.
+ */
+typedef struct
+{
+  uint64_t high; ///< Upper 64 bits.
+  uint64_t low;  ///< Lower 64 bits.
+} hosts_address_x;
+
+/**
+ * @brief A range of hosts, either consecutive addresses or a hostname.
+ */
+typedef struct
+{
+  hosts_range_type_x type; ///< Type of the range.
+  hosts_address_x first;   ///< First address of an address range.
+  hosts_address_x last;    ///< Last address of an address range.
+  const char *name;        ///< Hostname, points into the hosts string.
+  size_t name_length;      ///< Length of the hostname.
+} hosts_range_x;
+
+/**
+ * @brief Ranges of a hosts string.
+ */
+typedef struct
+{
+  hosts_range_x *ranges; ///< The ranges, consecutive in the arena.
+  size_t count;          ///< Number of ranges.
+  uint64_t hosts;        ///< Number of hosts including duplicates, saturated.
+  int normalized;        ///< Whether the ranges are sorted and merged.
+} hosts_list_x;
+
+/**
+ * @brief Memory supplied by the caller for the parser.
+ */
+typedef struct
+{
+  char *base;  ///< Start of the memory.
+  size_t size; ///< Size of the memory.
+  size_t used; ///< Bytes used.
+} hosts_arena_x;
+
+size_t
+hosts_parse_space_x (const char *, size_t);
+
+void
+hosts_arena_init_x (hosts_arena_x *, void *, size_t);
+
+int
+hosts_parse_x (const char *, size_t, int, int, hosts_arena_x *,
+               hosts_list_x *);
+
+int
+hosts_parse_alloc_x (const char *, int, hosts_list_x *);
+
+void
+hosts_list_normalize_x (hosts_list_x *);
+
+void
+hosts_list_count_wide_x (hosts_list_x *, hosts_list_x *, hosts_address_x *);
+
+uint64_t
+hosts_list_count_x (hosts_list_x *, hosts_list_x *);
+
+size_t
+hosts_subtract_space_x (const hosts_list_x *, const hosts_list_x *);
+
+int
+hosts_list_subtract_x (hosts_list_x *, hosts_list_x *, hosts_arena_x *,
+                       hosts_list_x *);
+
+void
+hosts_range_from_bytes_x (const unsigned char *, int, hosts_range_x *);
+
+void
+hosts_address_to_bytes_x (const hosts_address_x *, int, unsigned char *);
+
+int
+hosts_list_contains_x (const hosts_list_x *, const hosts_range_x *);
+
+int
+hosts_contains_x (const hosts_list_x *, const char *, size_t);
+
 int
 manage_count_hosts_max (const char *, const char *, int);
 
 int
 hosts_str_contains (const char *, const char *, int);
-#endif
\ No newline at end of file
+
+int
+parse_hosts_x (const char *, size_t, int, hosts_list_x *);
+
+void
+hosts_define_gucs_x (void);
+#endif
@@ -25,8 +25,39 @@
 #define _GVMD_MANAGE_UTILS_X_H
 
 #include <libical/ical.h>
+#include <stdint.h>
 #include <time.h>
 
+/**
+ * @brief End of the span of a recurrence without end.
+ */
+#define ICALENDAR_SPAN_OPEN_X INT64_MAX
+
+/**
+ * @brief Span of the occurrences of a schedule.
+ */
+typedef struct
+{
+  int64_t start;   ///< First occurrence.
+  int64_t end;     ///< Last occurrence, or ICALENDAR_SPAN_OPEN_X.
+  int64_t period;  ///< Longest time between occurrences, 0 if not known.
+} icalendar_span_x;
+
+typedef struct icalendar_guard_x icalendar_guard_x;
+
+typedef struct icalendar_occurrences_x icalendar_occurrences_x;
+
+extern int icalendar_max_iterations_x;
+
+void
+ical_define_gucs_x (void);
+
+icalendar_guard_x *
+icalendar_guard_component_x (icalcomponent *);
+
+void
+icalendar_guard_release_x (icalendar_guard_x *);
+
 icaltimezone *
 icalendar_timezone_from_string_x (const char *);
 
@@ -37,5 +68,27 @@ time_t
 icalendar_next_time_from_vcalendar_x (icalcomponent *, time_t, const char *,
                                       int);
 
+int
+icalendar_span_from_vcalendar_x (icalcomponent *, const char *,
+                                 icalendar_span_x *);
+
+int
+icalendar_occurs_between_x (icalcomponent *, const char *, time_t, time_t);
+
+icalendar_occurrences_x *
+icalendar_occurrences_new_x (icalcomponent *, const char *, time_t);
+
+int
+icalendar_occurrences_next_x (icalendar_occurrences_x *, time_t *);
+
+void
+icalendar_occurrences_free_x (icalendar_occurrences_x *);
+
+void
+icalendar_reset_iterations_x (void);
+
+long
+icalendar_iterations_x (void);
+
 #endif
 
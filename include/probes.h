@@ -0,0 +1,64 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file probes.h
+ * @brief Static tracepoints of the pg_gvm provider.
+ *
+ * If built with ENABLE_DTRACE the probes are USDT probes that cost a single
+ * no-op instruction until a tracer attaches, otherwise they are compiled out.
+ * The first argument of every probe is the name of the SQL function.
+ *
+ * parse__start (function, length): Before the input is parsed.
+ * parse__done (function, length, hosts): After the input is parsed, hosts is
+ *  the number of hosts of a hosts string, 0 otherwise.
+ * eval__start (function): Before the parsed input is evaluated.
+ * eval__done (function, result, steps): After the evaluation, steps is the
+ *  number of recurrence iterations, 0 otherwise.
+ */
+
+#ifndef _GVMD_PROBES_X_H
+#define _GVMD_PROBES_X_H
+
+#ifdef ENABLE_DTRACE
+
+#include <sys/sdt.h>
+
+#define PG_GVM_PARSE_START(function, length) \
+  DTRACE_PROBE2 (pg_gvm, parse__start, function, length)
+#define PG_GVM_PARSE_DONE(function, length, hosts) \
+  DTRACE_PROBE3 (pg_gvm, parse__done, function, length, hosts)
+#define PG_GVM_EVAL_START(function) \
+  DTRACE_PROBE1 (pg_gvm, eval__start, function)
+#define PG_GVM_EVAL_DONE(function, result, steps) \
+  DTRACE_PROBE3 (pg_gvm, eval__done, function, result, steps)
+
+#else /* not ENABLE_DTRACE */
+
+#define PG_GVM_PARSE_START(function, length) \
+  do {} while (0)
+#define PG_GVM_PARSE_DONE(function, length, hosts) \
+  do {} while (0)
+#define PG_GVM_EVAL_START(function) \
+  do {} while (0)
+#define PG_GVM_EVAL_DONE(function, result, steps) \
+  do {} while (0)
+
+#endif /* not ENABLE_DTRACE */
+
+#endif
@@ -0,0 +1,33 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file schedule_worker.h
+ * @brief Headers for the schedule due-queue worker
+ */
+
+#ifndef _GVMD_SCHEDULE_WORKER_X_H
+#define _GVMD_SCHEDULE_WORKER_X_H
+
+void
+schedule_worker_define_gucs_x (void);
+
+void
+schedule_worker_register_x (void);
+
+#endif
@@ -0,0 +1,76 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file stats.h
+ * @brief Headers for the function statistics in shared memory
+ */
+
+#ifndef _GVMD_STATS_X_H
+#define _GVMD_STATS_X_H
+
+#include "postgres.h"
+#include "portability/instr_time.h"
+
+/**
+ * @brief Functions with statistics.
+ */
+typedef enum
+{
+  STATS_HOSTS_CONTAINS_X,
+  STATS_MAX_HOSTS_X,
+  STATS_REGEXP_X,
+  STATS_NEXT_TIME_ICAL_X,
+  STATS_FUNCTIONS_X
+} stats_function_x;
+
+/**
+ * @brief Measurements of a single function call.
+ */
+typedef struct stats_call_x
+{
+  int active;           ///< Whether the call is measured.
+  instr_time start;     ///< Start of the call.
+  instr_time phase;     ///< Start of the current phase.
+  int64 parse_time;     ///< Microseconds spent parsing.
+  int64 eval_time;      ///< Microseconds spent evaluating.
+  int64 bytes_parsed;   ///< Number of bytes parsed.
+  int64 iterations;     ///< Number of recurrence iterations.
+  int64 cache_hits;     ///< Number of cache hits.
+  int64 cache_misses;   ///< Number of cache misses.
+} stats_call_x;
+
+void
+stats_define_gucs_x (void);
+
+void
+stats_shmem_request_x (void);
+
+void
+stats_shmem_startup_x (void);
+
+void
+stats_begin_x (stats_call_x *);
+
+void
+stats_parsed_x (stats_call_x *, int64);
+
+void
+stats_end_x (stats_call_x *, stats_function_x);
+
+#endif
@@ -0,0 +1,49 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file text_arg.h
+ * @brief Headers for reading text arguments without copying them
+ */
+
+#ifndef _GVMD_TEXT_ARG_X_H
+#define _GVMD_TEXT_ARG_X_H
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "nodes/pathnodes.h"
+
+/**
+ * @brief The bytes of a text argument, not terminated.
+ */
+typedef struct
+{
+  const char *data;   ///< First byte.
+  size_t length;      ///< Number of bytes.
+} text_arg_x;
+
+int
+text_arg_get_x (FunctionCallInfo, int, text_arg_x *);
+
+char *
+text_arg_cstring_x (const text_arg_x *);
+
+char *
+planner_const_text_x (PlannerInfo *, Node *);
+
+#endif
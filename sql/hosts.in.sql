@@ -16,12 +16,121 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+CREATE OR REPLACE FUNCTION hosts_contains_support (internal)
+    RETURNS internal
+    LANGUAGE C STRICT
+    AS 'MODULE_PATHNAME', $$sql_hosts_contains_support$$;
+
 CREATE OR REPLACE FUNCTION hosts_contains (text, text)
     RETURNS boolean
-    LANGUAGE C STRICT
+    LANGUAGE C STRICT STABLE PARALLEL SAFE
+    COST 200
+    SUPPORT hosts_contains_support
     AS 'MODULE_PATHNAME', $$sql_hosts_contains$$;
 
+CREATE OR REPLACE FUNCTION hosts_contains (text, inet)
+    RETURNS boolean
+    LANGUAGE C STRICT STABLE PARALLEL SAFE
+    COST 50
+    SUPPORT hosts_contains_support
+    AS 'MODULE_PATHNAME', $$sql_hosts_contains_inet$$;
+
+-- Whether an address is in the hosts of a target but not in its excluded
+--  hosts.  A NULL exclude excludes nothing.
+CREATE OR REPLACE FUNCTION hosts_contains (hosts text, exclude text,
+                                           host inet)
+    RETURNS boolean
+    LANGUAGE C STABLE PARALLEL SAFE
+    COST 50
+    SUPPORT hosts_contains_support
+    AS 'MODULE_PATHNAME', $$sql_hosts_contains_exclude$$;
+
 CREATE OR REPLACE FUNCTION max_hosts (text, text)
     RETURNS integer
-    LANGUAGE C STRICT
+    LANGUAGE C STRICT STABLE PARALLEL SAFE
+    COST 500
     AS 'MODULE_PATHNAME', $$sql_max_hosts$$;
+
+-- Exact number of hosts without the excluded hosts, also of IPv6 networks.
+--  Not limited by the maximum number of hosts.  NULL if the hosts are
+--  invalid, a NULL exclude excludes nothing.
+CREATE OR REPLACE FUNCTION hosts_count (hosts text, exclude text DEFAULT NULL)
+    RETURNS numeric
+    LANGUAGE C IMMUTABLE PARALLEL SAFE
+    COST 500
+    AS 'MODULE_PATHNAME', $$sql_hosts_count$$;
+
+CREATE OR REPLACE FUNCTION pg_gvm_host_cache_stats (OUT hits bigint,
+                                                    OUT misses bigint,
+                                                    OUT evictions bigint,
+                                                    OUT entries integer,
+                                                    OUT size integer)
+    RETURNS record
+    LANGUAGE C STRICT VOLATILE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_host_cache_stats$$;
+
+-- Address ranges of the hosts of a target without its excluded hosts, merged
+--  and in ascending order.  Hostnames are left out.  A NULL exclude excludes
+--  nothing.  Lets a join with a table of addresses use an index:
+--  SELECT ... FROM targets t, hosts_ranges (t.hosts, t.exclude_hosts) r
+--    JOIN results ON host BETWEEN r.lo AND r.hi;
+CREATE OR REPLACE FUNCTION hosts_ranges (hosts text, exclude text)
+    RETURNS TABLE (lo inet, hi inet)
+    LANGUAGE C STABLE PARALLEL SAFE
+    COST 500
+    ROWS 10
+    AS 'MODULE_PATHNAME', $$sql_hosts_ranges$$;
+
+-- Aggregates of the distinct hosts of many hosts strings, for example of all
+--  targets of a user.  Invalid hosts strings are skipped.
+CREATE OR REPLACE FUNCTION hosts_agg_transfn (internal, text)
+    RETURNS internal
+    LANGUAGE C STABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_hosts_agg_transfn$$;
+
+CREATE OR REPLACE FUNCTION hosts_agg_combinefn (internal, internal)
+    RETURNS internal
+    LANGUAGE C IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_hosts_agg_combinefn$$;
+
+CREATE OR REPLACE FUNCTION hosts_agg_serialfn (internal)
+    RETURNS bytea
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_hosts_agg_serialfn$$;
+
+CREATE OR REPLACE FUNCTION hosts_agg_deserialfn (bytea, internal)
+    RETURNS internal
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_hosts_agg_deserialfn$$;
+
+CREATE OR REPLACE FUNCTION hosts_count_distinct_agg_finalfn (internal)
+    RETURNS bigint
+    LANGUAGE C IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_hosts_count_distinct_agg_finalfn$$;
+
+CREATE OR REPLACE FUNCTION hosts_union_agg_finalfn (internal)
+    RETURNS text
+    LANGUAGE C IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_hosts_union_agg_finalfn$$;
+
+-- Number of distinct hosts of all hosts strings.
+CREATE OR REPLACE AGGREGATE hosts_count_distinct_agg (text) (
+    SFUNC = hosts_agg_transfn,
+    STYPE = internal,
+    FINALFUNC = hosts_count_distinct_agg_finalfn,
+    COMBINEFUNC = hosts_agg_combinefn,
+    SERIALFUNC = hosts_agg_serialfn,
+    DESERIALFUNC = hosts_agg_deserialfn,
+    PARALLEL = SAFE
+);
+
+-- Distinct hosts of all hosts strings as a single hosts string.
+CREATE OR REPLACE AGGREGATE hosts_union_agg (text) (
+    SFUNC = hosts_agg_transfn,
+    STYPE = internal,
+    FINALFUNC = hosts_union_agg_finalfn,
+    COMBINEFUNC = hosts_agg_combinefn,
+    SERIALFUNC = hosts_agg_serialfn,
+    DESERIALFUNC = hosts_agg_deserialfn,
+    PARALLEL = SAFE
+);
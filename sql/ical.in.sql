@@ -18,10 +18,29 @@
 
 CREATE OR REPLACE FUNCTION next_time_ical (text, bigint, text)
     RETURNS integer
-    LANGUAGE C STRICT
+    LANGUAGE C STRICT STABLE PARALLEL SAFE
+    COST 1000
     AS 'MODULE_PATHNAME', $$sql_next_time_ical$$;
 
 CREATE OR REPLACE FUNCTION next_time_ical (text, bigint, text, integer)
     RETURNS integer
-    LANGUAGE C STRICT
+    LANGUAGE C STRICT STABLE PARALLEL SAFE
+    COST 1000
     AS 'MODULE_PATHNAME', $$sql_next_time_ical$$;
+
+-- Schedules running at the same time between from_time and to_time.  The
+--  conflicting pairs are returned as 1-based indexes into icals, the first
+--  index of each pair in first_schedules and the second in second_schedules.
+--  durations are in seconds.
+CREATE OR REPLACE FUNCTION ical_overlaps (icals text[],
+                                          durations integer[],
+                                          from_time bigint,
+                                          to_time bigint,
+                                          OUT first_schedules integer[],
+                                          OUT second_schedules integer[],
+                                          OUT peak integer,
+                                          OUT peak_time bigint)
+    RETURNS record
+    LANGUAGE C STRICT STABLE PARALLEL SAFE
+    COST 100000
+    AS 'MODULE_PATHNAME', $$sql_ical_overlaps$$;
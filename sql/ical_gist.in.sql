@@ -0,0 +1,104 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+-- Span of the occurrences of a schedule: first and last occurrence and the
+--  longest time between two occurrences, as "(start,end,period)".
+CREATE TYPE ical_span;
+
+CREATE OR REPLACE FUNCTION ical_span_in (cstring)
+    RETURNS ical_span
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_ical_span_in$$;
+
+CREATE OR REPLACE FUNCTION ical_span_out (ical_span)
+    RETURNS cstring
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_ical_span_out$$;
+
+CREATE TYPE ical_span (
+    INPUT = ical_span_in,
+    OUTPUT = ical_span_out,
+    INTERNALLENGTH = 24,
+    ALIGNMENT = double
+);
+
+CREATE OR REPLACE FUNCTION ical_span (text)
+    RETURNS ical_span
+    LANGUAGE C STRICT STABLE PARALLEL SAFE
+    COST 1000
+    AS 'MODULE_PATHNAME', $$sql_ical_span$$;
+
+-- Whether a schedule has an occurrence in a time range.
+CREATE OR REPLACE FUNCTION ical_occurs_in (text, tstzrange)
+    RETURNS boolean
+    LANGUAGE C STRICT STABLE PARALLEL SAFE
+    COST 1000
+    AS 'MODULE_PATHNAME', $$sql_ical_occurs_in$$;
+
+CREATE OPERATOR && (
+    LEFTARG = text,
+    RIGHTARG = tstzrange,
+    FUNCTION = ical_occurs_in,
+    RESTRICT = contsel,
+    JOIN = contjoinsel
+);
+
+-- GiST operator class indexing the spans of schedules.
+
+CREATE OR REPLACE FUNCTION gist_ical_consistent (internal, tstzrange,
+                                                 smallint, oid, internal)
+    RETURNS boolean
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_gist_ical_consistent$$;
+
+CREATE OR REPLACE FUNCTION gist_ical_union (internal, internal)
+    RETURNS ical_span
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_gist_ical_union$$;
+
+CREATE OR REPLACE FUNCTION gist_ical_compress (internal)
+    RETURNS internal
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_gist_ical_compress$$;
+
+CREATE OR REPLACE FUNCTION gist_ical_penalty (internal, internal, internal)
+    RETURNS internal
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_gist_ical_penalty$$;
+
+CREATE OR REPLACE FUNCTION gist_ical_picksplit (internal, internal)
+    RETURNS internal
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_gist_ical_picksplit$$;
+
+CREATE OR REPLACE FUNCTION gist_ical_same (ical_span, ical_span, internal)
+    RETURNS internal
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_gist_ical_same$$;
+
+CREATE OPERATOR CLASS gist_ical_ops
+    FOR TYPE text USING gist AS
+        OPERATOR 3 && (text, tstzrange),
+        FUNCTION 1 gist_ical_consistent (internal, tstzrange, smallint, oid,
+                                         internal),
+        FUNCTION 2 gist_ical_union (internal, internal),
+        FUNCTION 3 gist_ical_compress (internal),
+        FUNCTION 5 gist_ical_penalty (internal, internal, internal),
+        FUNCTION 6 gist_ical_picksplit (internal, internal),
+        FUNCTION 7 gist_ical_same (ical_span, ical_span, internal),
+        STORAGE ical_span;
@@ -16,7 +16,14 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+CREATE OR REPLACE FUNCTION regexp_support (internal)
+    RETURNS internal
+    LANGUAGE C STRICT
+    AS 'MODULE_PATHNAME', $$sql_regexp_support$$;
+
 CREATE OR REPLACE FUNCTION regexp (text, text)
     RETURNS boolean
-    LANGUAGE C STRICT
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    COST 50
+    SUPPORT regexp_support
     AS 'MODULE_PATHNAME', $$sql_regexp$$;
@@ -0,0 +1,169 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+-- Next occurrence of every schedule, kept up to date by
+--  pg_gvm_schedule_due_refresh.  next_time is NULL if there are no more
+--  occurrences or the schedule could not be evaluated.
+CREATE TABLE IF NOT EXISTS pg_gvm_schedule_due
+  (schedule_id bigint PRIMARY KEY,
+   icalendar text NOT NULL,
+   timezone text,
+   next_time bigint,
+   error text,
+   modified timestamp with time zone NOT NULL DEFAULT now ());
+
+CREATE INDEX IF NOT EXISTS pg_gvm_schedule_due_next_time_idx
+  ON pg_gvm_schedule_due (next_time);
+
+-- Changed schedules, filled by pg_gvm_schedule_queue_trigger.
+CREATE TABLE IF NOT EXISTS pg_gvm_schedule_queue
+  (id bigserial PRIMARY KEY,
+   schedule_id bigint NOT NULL,
+   icalendar text,
+   timezone text,
+   deleted boolean NOT NULL DEFAULT false);
+
+SELECT pg_catalog.pg_extension_config_dump ('pg_gvm_schedule_due', '');
+
+-- Trigger function queueing changed schedules.  The arguments of the trigger
+--  are the names of the id, iCalendar and timezone columns, for example:
+--  CREATE TRIGGER schedules_due AFTER INSERT OR UPDATE OR DELETE ON schedules
+--    FOR EACH ROW EXECUTE FUNCTION
+--    pg_gvm_schedule_queue_trigger ('id', 'icalendar', 'timezone');
+CREATE OR REPLACE FUNCTION pg_gvm_schedule_queue_trigger ()
+    RETURNS trigger
+    LANGUAGE plpgsql
+    AS $$
+DECLARE
+    old_row jsonb;
+    new_row jsonb;
+BEGIN
+    IF TG_NARGS <> 3 THEN
+      RAISE EXCEPTION 'pg_gvm_schedule_queue_trigger needs the id, iCalendar'
+                      ' and timezone columns as arguments';
+    END IF;
+
+    IF TG_OP = 'DELETE' THEN
+      old_row = to_jsonb (OLD);
+      INSERT INTO @extschema@.pg_gvm_schedule_queue (schedule_id, deleted)
+        VALUES ((old_row ->> TG_ARGV[0])::bigint, true);
+      RETURN OLD;
+    END IF;
+
+    new_row = to_jsonb (NEW);
+    IF TG_OP = 'UPDATE' THEN
+      old_row = to_jsonb (OLD);
+      IF old_row ->> TG_ARGV[0] IS NOT DISTINCT FROM new_row ->> TG_ARGV[0]
+         AND old_row ->> TG_ARGV[1] IS NOT DISTINCT FROM new_row ->> TG_ARGV[1]
+         AND old_row ->> TG_ARGV[2] IS NOT DISTINCT FROM new_row ->> TG_ARGV[2]
+      THEN
+        RETURN NEW;
+      END IF;
+      IF old_row ->> TG_ARGV[0] IS DISTINCT FROM new_row ->> TG_ARGV[0] THEN
+        INSERT INTO @extschema@.pg_gvm_schedule_queue (schedule_id, deleted)
+          VALUES ((old_row ->> TG_ARGV[0])::bigint, true);
+      END IF;
+    END IF;
+
+    INSERT INTO @extschema@.pg_gvm_schedule_queue
+        (schedule_id, icalendar, timezone)
+      VALUES ((new_row ->> TG_ARGV[0])::bigint,
+              new_row ->> TG_ARGV[1],
+              new_row ->> TG_ARGV[2]);
+    RETURN NEW;
+END;
+$$;
+
+-- Apply the queued changes and advance the schedules whose next occurrence
+--  has passed.  Returns the number of updated schedules.  Called by the
+--  schedule worker, but may also be called directly.
+CREATE OR REPLACE FUNCTION pg_gvm_schedule_due_refresh
+    (reference_time bigint DEFAULT extract (epoch FROM now ())::bigint)
+    RETURNS integer
+    LANGUAGE plpgsql
+    AS $$
+DECLARE
+    change record;
+    updated integer := 0;
+BEGIN
+    -- Only the last change of each schedule matters.
+    FOR change IN
+      WITH queued AS
+        (DELETE FROM @extschema@.pg_gvm_schedule_queue RETURNING *)
+      SELECT DISTINCT ON (schedule_id) *
+      FROM queued
+      ORDER BY schedule_id, id DESC
+    LOOP
+      IF change.deleted OR change.icalendar IS NULL THEN
+        DELETE FROM @extschema@.pg_gvm_schedule_due
+          WHERE schedule_id = change.schedule_id;
+      ELSE
+        INSERT INTO @extschema@.pg_gvm_schedule_due
+            (schedule_id, icalendar, timezone)
+          VALUES (change.schedule_id, change.icalendar, change.timezone)
+          ON CONFLICT (schedule_id) DO UPDATE
+            SET icalendar = excluded.icalendar,
+                timezone = excluded.timezone,
+                next_time = NULL,
+                error = NULL,
+                modified = now ();
+        PERFORM @extschema@.pg_gvm_schedule_due_update (change.schedule_id,
+                                                        reference_time);
+      END IF;
+      updated = updated + 1;
+    END LOOP;
+
+    -- Advance the passed occurrences, using the index on next_time.
+    FOR change IN
+      SELECT schedule_id FROM @extschema@.pg_gvm_schedule_due
+      WHERE next_time <= reference_time
+    LOOP
+      PERFORM @extschema@.pg_gvm_schedule_due_update (change.schedule_id,
+                                                      reference_time);
+      updated = updated + 1;
+    END LOOP;
+
+    RETURN updated;
+END;
+$$;
+
+-- Calculate the next occurrence of a single schedule.  Errors are kept in
+--  the row instead of failing the whole refresh.
+CREATE OR REPLACE FUNCTION pg_gvm_schedule_due_update (schedule bigint,
+                                                       reference_time bigint)
+    RETURNS void
+    LANGUAGE plpgsql
+    AS $$
+BEGIN
+    UPDATE @extschema@.pg_gvm_schedule_due
+      SET next_time = nullif (@extschema@.next_time_ical (icalendar,
+                                                          reference_time,
+                                                          coalesce (timezone,
+                                                                    'UTC')),
+                              0),
+          error = NULL,
+          modified = now ()
+      WHERE schedule_id = schedule;
+EXCEPTION WHEN others THEN
+    UPDATE @extschema@.pg_gvm_schedule_due
+      SET next_time = NULL,
+          error = SQLERRM,
+          modified = now ()
+      WHERE schedule_id = schedule;
+END;
+$$;
@@ -0,0 +1,42 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+CREATE OR REPLACE FUNCTION pg_gvm_stats (OUT funcname text,
+                                         OUT calls bigint,
+                                         OUT total_time double precision,
+                                         OUT max_time double precision,
+                                         OUT parse_time double precision,
+                                         OUT eval_time double precision,
+                                         OUT bytes_parsed bigint,
+                                         OUT iterations bigint,
+                                         OUT cache_hits bigint,
+                                         OUT cache_misses bigint,
+                                         OUT stats_reset timestamp with time zone)
+    RETURNS SETOF record
+    LANGUAGE C STRICT VOLATILE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_stats$$;
+
+CREATE OR REPLACE VIEW pg_gvm_stats AS
+    SELECT * FROM pg_gvm_stats ();
+
+CREATE OR REPLACE FUNCTION pg_gvm_stats_reset ()
+    RETURNS void
+    LANGUAGE C STRICT VOLATILE PARALLEL RESTRICTED
+    AS 'MODULE_PATHNAME', $$sql_stats_reset$$;
+
+REVOKE ALL ON FUNCTION pg_gvm_stats_reset () FROM PUBLIC;
@@ -0,0 +1,441 @@
+/* SPDX-FileCopyrightText: 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+-- Declare volatility, parallel safety and cost of all functions, so the
+-- planner can fold constants and choose parallel plans.
+
+ALTER FUNCTION regexp (text, text)
+    IMMUTABLE PARALLEL SAFE COST 50;
+
+ALTER FUNCTION hosts_contains (text, text)
+    STABLE PARALLEL SAFE COST 200;
+
+ALTER FUNCTION max_hosts (text, text)
+    STABLE PARALLEL SAFE COST 500;
+
+ALTER FUNCTION next_time_ical (text, bigint, text)
+    STABLE PARALLEL SAFE COST 1000;
+
+ALTER FUNCTION next_time_ical (text, bigint, text, integer)
+    STABLE PARALLEL SAFE COST 1000;
+
+-- Planner support functions for selectivity and cost estimates.
+
+CREATE OR REPLACE FUNCTION hosts_contains_support (internal)
+    RETURNS internal
+    LANGUAGE C STRICT
+    AS 'MODULE_PATHNAME', $$sql_hosts_contains_support$$;
+
+ALTER FUNCTION hosts_contains (text, text)
+    SUPPORT hosts_contains_support;
+
+CREATE OR REPLACE FUNCTION regexp_support (internal)
+    RETURNS internal
+    LANGUAGE C STRICT
+    AS 'MODULE_PATHNAME', $$sql_regexp_support$$;
+
+ALTER FUNCTION regexp (text, text)
+    SUPPORT regexp_support;
+
+-- Counters of the shared host count cache.
+
+CREATE OR REPLACE FUNCTION pg_gvm_host_cache_stats (OUT hits bigint,
+                                                    OUT misses bigint,
+                                                    OUT evictions bigint,
+                                                    OUT entries integer,
+                                                    OUT size integer)
+    RETURNS record
+    LANGUAGE C STRICT VOLATILE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_host_cache_stats$$;
+
+-- Statistics of the function calls.
+
+CREATE OR REPLACE FUNCTION pg_gvm_stats (OUT funcname text,
+                                         OUT calls bigint,
+                                         OUT total_time double precision,
+                                         OUT max_time double precision,
+                                         OUT parse_time double precision,
+                                         OUT eval_time double precision,
+                                         OUT bytes_parsed bigint,
+                                         OUT iterations bigint,
+                                         OUT cache_hits bigint,
+                                         OUT cache_misses bigint,
+                                         OUT stats_reset timestamp with time zone)
+    RETURNS SETOF record
+    LANGUAGE C STRICT VOLATILE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_stats$$;
+
+CREATE OR REPLACE VIEW pg_gvm_stats AS
+    SELECT * FROM pg_gvm_stats ();
+
+CREATE OR REPLACE FUNCTION pg_gvm_stats_reset ()
+    RETURNS void
+    LANGUAGE C STRICT VOLATILE PARALLEL RESTRICTED
+    AS 'MODULE_PATHNAME', $$sql_stats_reset$$;
+
+REVOKE ALL ON FUNCTION pg_gvm_stats_reset () FROM PUBLIC;
+
+-- Schedule due-queue, refreshed by the schedule worker.
+
+-- Next occurrence of every schedule, kept up to date by
+--  pg_gvm_schedule_due_refresh.  next_time is NULL if there are no more
+--  occurrences or the schedule could not be evaluated.
+CREATE TABLE IF NOT EXISTS pg_gvm_schedule_due
+  (schedule_id bigint PRIMARY KEY,
+   icalendar text NOT NULL,
+   timezone text,
+   next_time bigint,
+   error text,
+   modified timestamp with time zone NOT NULL DEFAULT now ());
+
+CREATE INDEX IF NOT EXISTS pg_gvm_schedule_due_next_time_idx
+  ON pg_gvm_schedule_due (next_time);
+
+-- Changed schedules, filled by pg_gvm_schedule_queue_trigger.
+CREATE TABLE IF NOT EXISTS pg_gvm_schedule_queue
+  (id bigserial PRIMARY KEY,
+   schedule_id bigint NOT NULL,
+   icalendar text,
+   timezone text,
+   deleted boolean NOT NULL DEFAULT false);
+
+SELECT pg_catalog.pg_extension_config_dump ('pg_gvm_schedule_due', '');
+
+-- Trigger function queueing changed schedules.  The arguments of the trigger
+--  are the names of the id, iCalendar and timezone columns, for example:
+--  CREATE TRIGGER schedules_due AFTER INSERT OR UPDATE OR DELETE ON schedules
+--    FOR EACH ROW EXECUTE FUNCTION
+--    pg_gvm_schedule_queue_trigger ('id', 'icalendar', 'timezone');
+CREATE OR REPLACE FUNCTION pg_gvm_schedule_queue_trigger ()
+    RETURNS trigger
+    LANGUAGE plpgsql
+    AS $$
+DECLARE
+    old_row jsonb;
+    new_row jsonb;
+BEGIN
+    IF TG_NARGS <> 3 THEN
+      RAISE EXCEPTION 'pg_gvm_schedule_queue_trigger needs the id, iCalendar'
+                      ' and timezone columns as arguments';
+    END IF;
+
+    IF TG_OP = 'DELETE' THEN
+      old_row = to_jsonb (OLD);
+      INSERT INTO @extschema@.pg_gvm_schedule_queue (schedule_id, deleted)
+        VALUES ((old_row ->> TG_ARGV[0])::bigint, true);
+      RETURN OLD;
+    END IF;
+
+    new_row = to_jsonb (NEW);
+    IF TG_OP = 'UPDATE' THEN
+      old_row = to_jsonb (OLD);
+      IF old_row ->> TG_ARGV[0] IS NOT DISTINCT FROM new_row ->> TG_ARGV[0]
+         AND old_row ->> TG_ARGV[1] IS NOT DISTINCT FROM new_row ->> TG_ARGV[1]
+         AND old_row ->> TG_ARGV[2] IS NOT DISTINCT FROM new_row ->> TG_ARGV[2]
+      THEN
+        RETURN NEW;
+      END IF;
+      IF old_row ->> TG_ARGV[0] IS DISTINCT FROM new_row ->> TG_ARGV[0] THEN
+        INSERT INTO @extschema@.pg_gvm_schedule_queue (schedule_id, deleted)
+          VALUES ((old_row ->> TG_ARGV[0])::bigint, true);
+      END IF;
+    END IF;
+
+    INSERT INTO @extschema@.pg_gvm_schedule_queue
+        (schedule_id, icalendar, timezone)
+      VALUES ((new_row ->> TG_ARGV[0])::bigint,
+              new_row ->> TG_ARGV[1],
+              new_row ->> TG_ARGV[2]);
+    RETURN NEW;
+END;
+$$;
+
+-- Apply the queued changes and advance the schedules whose next occurrence
+--  has passed.  Returns the number of updated schedules.  Called by the
+--  schedule worker, but may also be called directly.
+CREATE OR REPLACE FUNCTION pg_gvm_schedule_due_refresh
+    (reference_time bigint DEFAULT extract (epoch FROM now ())::bigint)
+    RETURNS integer
+    LANGUAGE plpgsql
+    AS $$
+DECLARE
+    change record;
+    updated integer := 0;
+BEGIN
+    -- Only the last change of each schedule matters.
+    FOR change IN
+      WITH queued AS
+        (DELETE FROM @extschema@.pg_gvm_schedule_queue RETURNING *)
+      SELECT DISTINCT ON (schedule_id) *
+      FROM queued
+      ORDER BY schedule_id, id DESC
+    LOOP
+      IF change.deleted OR change.icalendar IS NULL THEN
+        DELETE FROM @extschema@.pg_gvm_schedule_due
+          WHERE schedule_id = change.schedule_id;
+      ELSE
+        INSERT INTO @extschema@.pg_gvm_schedule_due
+            (schedule_id, icalendar, timezone)
+          VALUES (change.schedule_id, change.icalendar, change.timezone)
+          ON CONFLICT (schedule_id) DO UPDATE
+            SET icalendar = excluded.icalendar,
+                timezone = excluded.timezone,
+                next_time = NULL,
+                error = NULL,
+                modified = now ();
+        PERFORM @extschema@.pg_gvm_schedule_due_update (change.schedule_id,
+                                                        reference_time);
+      END IF;
+      updated = updated + 1;
+    END LOOP;
+
+    -- Advance the passed occurrences, using the index on next_time.
+    FOR change IN
+      SELECT schedule_id FROM @extschema@.pg_gvm_schedule_due
+      WHERE next_time <= reference_time
+    LOOP
+      PERFORM @extschema@.pg_gvm_schedule_due_update (change.schedule_id,
+                                                      reference_time);
+      updated = updated + 1;
+    END LOOP;
+
+    RETURN updated;
+END;
+$$;
+
+-- Calculate the next occurrence of a single schedule.  Errors are kept in
+--  the row instead of failing the whole refresh.
+CREATE OR REPLACE FUNCTION pg_gvm_schedule_due_update (schedule bigint,
+                                                       reference_time bigint)
+    RETURNS void
+    LANGUAGE plpgsql
+    AS $$
+BEGIN
+    UPDATE @extschema@.pg_gvm_schedule_due
+      SET next_time = nullif (@extschema@.next_time_ical (icalendar,
+                                                          reference_time,
+                                                          coalesce (timezone,
+                                                                    'UTC')),
+                              0),
+          error = NULL,
+          modified = now ()
+      WHERE schedule_id = schedule;
+EXCEPTION WHEN others THEN
+    UPDATE @extschema@.pg_gvm_schedule_due
+      SET next_time = NULL,
+          error = SQLERRM,
+          modified = now ()
+      WHERE schedule_id = schedule;
+END;
+$$;
+
+-- Index support for schedules with an occurrence in a time range.
+
+-- Span of the occurrences of a schedule: first and last occurrence and the
+--  longest time between two occurrences, as "(start,end,period)".
+CREATE TYPE ical_span;
+
+CREATE OR REPLACE FUNCTION ical_span_in (cstring)
+    RETURNS ical_span
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_ical_span_in$$;
+
+CREATE OR REPLACE FUNCTION ical_span_out (ical_span)
+    RETURNS cstring
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_ical_span_out$$;
+
+CREATE TYPE ical_span (
+    INPUT = ical_span_in,
+    OUTPUT = ical_span_out,
+    INTERNALLENGTH = 24,
+    ALIGNMENT = double
+);
+
+CREATE OR REPLACE FUNCTION ical_span (text)
+    RETURNS ical_span
+    LANGUAGE C STRICT STABLE PARALLEL SAFE
+    COST 1000
+    AS 'MODULE_PATHNAME', $$sql_ical_span$$;
+
+-- Whether a schedule has an occurrence in a time range.
+CREATE OR REPLACE FUNCTION ical_occurs_in (text, tstzrange)
+    RETURNS boolean
+    LANGUAGE C STRICT STABLE PARALLEL SAFE
+    COST 1000
+    AS 'MODULE_PATHNAME', $$sql_ical_occurs_in$$;
+
+CREATE OPERATOR && (
+    LEFTARG = text,
+    RIGHTARG = tstzrange,
+    FUNCTION = ical_occurs_in,
+    RESTRICT = contsel,
+    JOIN = contjoinsel
+);
+
+-- GiST operator class indexing the spans of schedules.
+
+CREATE OR REPLACE FUNCTION gist_ical_consistent (internal, tstzrange,
+                                                 smallint, oid, internal)
+    RETURNS boolean
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_gist_ical_consistent$$;
+
+CREATE OR REPLACE FUNCTION gist_ical_union (internal, internal)
+    RETURNS ical_span
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_gist_ical_union$$;
+
+CREATE OR REPLACE FUNCTION gist_ical_compress (internal)
+    RETURNS internal
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_gist_ical_compress$$;
+
+CREATE OR REPLACE FUNCTION gist_ical_penalty (internal, internal, internal)
+    RETURNS internal
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_gist_ical_penalty$$;
+
+CREATE OR REPLACE FUNCTION gist_ical_picksplit (internal, internal)
+    RETURNS internal
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_gist_ical_picksplit$$;
+
+CREATE OR REPLACE FUNCTION gist_ical_same (ical_span, ical_span, internal)
+    RETURNS internal
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_gist_ical_same$$;
+
+CREATE OPERATOR CLASS gist_ical_ops
+    FOR TYPE text USING gist AS
+        OPERATOR 3 && (text, tstzrange),
+        FUNCTION 1 gist_ical_consistent (internal, tstzrange, smallint, oid,
+                                         internal),
+        FUNCTION 2 gist_ical_union (internal, internal),
+        FUNCTION 3 gist_ical_compress (internal),
+        FUNCTION 5 gist_ical_penalty (internal, internal, internal),
+        FUNCTION 6 gist_ical_picksplit (internal, internal),
+        FUNCTION 7 gist_ical_same (ical_span, ical_span, internal),
+        STORAGE ical_span;
+
+-- Conflicts and concurrency of schedules.
+
+-- Schedules running at the same time between from_time and to_time.  The
+--  conflicting pairs are returned as 1-based indexes into icals, the first
+--  index of each pair in first_schedules and the second in second_schedules.
+--  durations are in seconds.
+CREATE OR REPLACE FUNCTION ical_overlaps (icals text[],
+                                          durations integer[],
+                                          from_time bigint,
+                                          to_time bigint,
+                                          OUT first_schedules integer[],
+                                          OUT second_schedules integer[],
+                                          OUT peak integer,
+                                          OUT peak_time bigint)
+    RETURNS record
+    LANGUAGE C STRICT STABLE PARALLEL SAFE
+    COST 100000
+    AS 'MODULE_PATHNAME', $$sql_ical_overlaps$$;
+
+-- Membership of addresses in the hosts of a target.
+
+CREATE OR REPLACE FUNCTION hosts_contains (text, inet)
+    RETURNS boolean
+    LANGUAGE C STRICT STABLE PARALLEL SAFE
+    COST 50
+    SUPPORT hosts_contains_support
+    AS 'MODULE_PATHNAME', $$sql_hosts_contains_inet$$;
+
+-- Whether an address is in the hosts of a target but not in its excluded
+--  hosts.  A NULL exclude excludes nothing.
+CREATE OR REPLACE FUNCTION hosts_contains (hosts text, exclude text,
+                                           host inet)
+    RETURNS boolean
+    LANGUAGE C STABLE PARALLEL SAFE
+    COST 50
+    SUPPORT hosts_contains_support
+    AS 'MODULE_PATHNAME', $$sql_hosts_contains_exclude$$;
+
+-- Aggregates of the hosts of many hosts strings.
+
+-- Aggregates of the distinct hosts of many hosts strings, for example of all
+--  targets of a user.  Invalid hosts strings are skipped.
+CREATE OR REPLACE FUNCTION hosts_agg_transfn (internal, text)
+    RETURNS internal
+    LANGUAGE C STABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_hosts_agg_transfn$$;
+
+CREATE OR REPLACE FUNCTION hosts_agg_combinefn (internal, internal)
+    RETURNS internal
+    LANGUAGE C IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_hosts_agg_combinefn$$;
+
+CREATE OR REPLACE FUNCTION hosts_agg_serialfn (internal)
+    RETURNS bytea
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_hosts_agg_serialfn$$;
+
+CREATE OR REPLACE FUNCTION hosts_agg_deserialfn (bytea, internal)
+    RETURNS internal
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_hosts_agg_deserialfn$$;
+
+CREATE OR REPLACE FUNCTION hosts_count_distinct_agg_finalfn (internal)
+    RETURNS bigint
+    LANGUAGE C IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_hosts_count_distinct_agg_finalfn$$;
+
+CREATE OR REPLACE FUNCTION hosts_union_agg_finalfn (internal)
+    RETURNS text
+    LANGUAGE C IMMUTABLE PARALLEL SAFE
+    AS 'MODULE_PATHNAME', $$sql_hosts_union_agg_finalfn$$;
+
+-- Number of distinct hosts of all hosts strings.
+CREATE OR REPLACE AGGREGATE hosts_count_distinct_agg (text) (
+    SFUNC = hosts_agg_transfn,
+    STYPE = internal,
+    FINALFUNC = hosts_count_distinct_agg_finalfn,
+    COMBINEFUNC = hosts_agg_combinefn,
+    SERIALFUNC = hosts_agg_serialfn,
+    DESERIALFUNC = hosts_agg_deserialfn,
+    PARALLEL = SAFE
+);
+
+-- Distinct hosts of all hosts strings as a single hosts string.
+CREATE OR REPLACE AGGREGATE hosts_union_agg (text) (
+    SFUNC = hosts_agg_transfn,
+    STYPE = internal,
+    FINALFUNC = hosts_union_agg_finalfn,
+    COMBINEFUNC = hosts_agg_combinefn,
+    SERIALFUNC = hosts_agg_serialfn,
+    DESERIALFUNC = hosts_agg_deserialfn,
+    PARALLEL = SAFE
+);
+
+-- Address ranges of the hosts of a target.
+
+-- Address ranges of the hosts of a target without its excluded hosts, merged
+--  and in ascending order.  Hostnames are left out.  A NULL exclude excludes
+--  nothing.  Lets a join with a table of addresses use an index:
+--  SELECT ... FROM targets t, hosts_ranges (t.hosts, t.exclude_hosts) r
+--    JOIN results ON host BETWEEN r.lo AND r.hi;
+CREATE OR REPLACE FUNCTION hosts_ranges (hosts text, exclude text)
+    RETURNS TABLE (lo inet, hi inet)
+    LANGUAGE C STABLE PARALLEL SAFE
+    COST 500
+    ROWS 10
+    AS 'MODULE_PATHNAME', $$sql_hosts_ranges$$;
+
+-- Exact count of IPv6 hosts.
+
+-- Exact number of hosts without the excluded hosts, also of IPv6 networks.
+--  Not limited by the maximum number of hosts.  NULL if the hosts are
+--  invalid, a NULL exclude excludes nothing.
+CREATE OR REPLACE FUNCTION hosts_count (hosts text, exclude text DEFAULT NULL)
+    RETURNS numeric
+    LANGUAGE C IMMUTABLE PARALLEL SAFE
+    COST 500
+    AS 'MODULE_PATHNAME', $$sql_hosts_count$$;
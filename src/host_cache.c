@@ -0,0 +1,372 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file host_cache.c
+ * @brief Host count cache in shared memory.
+ *
+ * Counts computed by max_hosts are kept in a fixed size hash table in the
+ * main shared memory segment, so that all backends share them.  Entries are
+ * evicted with the second chance algorithm when the table is full: a hit
+ * only marks the entry as referenced, so that lookups share the lock, and
+ * the list of entries is reordered while storing.  The cache is only
+ * available if the library is loaded via shared_preload_libraries.
+ */
+
+#include "host_cache.h"
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "access/htup_details.h"
+#include "funcapi.h"
+#include "lib/ilist.h"
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+#if PG_VERSION_NUM >= 130000
+#include "common/hashfn.h"
+#else
+#include "utils/hashutils.h"
+#endif
+
+/**
+ * @brief Key of a cache entry.
+ *
+ * The strings are identified by two hashes and their lengths.
+ */
+typedef struct host_cache_key_x
+{
+  uint64 hosts_hash;
+  uint64 exclude_hash;
+  uint32 hosts_len;
+  uint32 exclude_len;
+  int32 max_hosts;
+} host_cache_key_x;
+
+/**
+ * @brief Cache entry.
+ */
+typedef struct host_cache_entry_x
+{
+  host_cache_key_x key;
+  int count;
+  pg_atomic_uint32 referenced; ///< Whether the entry was hit since stored.
+  dlist_node lru_node;
+} host_cache_entry_x;
+
+/**
+ * @brief State of the cache shared between all backends.
+ */
+typedef struct host_cache_shared_x
+{
+  LWLock *lock;
+  dlist_head lru;
+  int entries;
+  pg_atomic_uint64 hits;
+  pg_atomic_uint64 misses;
+  pg_atomic_uint64 evictions;
+} host_cache_shared_x;
+
+/**
+ * @brief Name of the LWLock tranche of the cache.
+ */
+#define HOST_CACHE_TRANCHE "pg-gvm host cache"
+
+/**
+ * @brief Maximum number of entries, set by pg_gvm.host_cache_size.
+ */
+static int host_cache_size = 1024;
+
+/**
+ * @brief Shared state, NULL if the cache is not available.
+ */
+static host_cache_shared_x *host_cache = NULL;
+
+/**
+ * @brief Shared hash table of the cache entries.
+ */
+static HTAB *host_cache_table = NULL;
+
+/**
+ * @brief Define the configuration variables of the cache.
+ */
+void
+host_cache_define_gucs_x (void)
+{
+  DefineCustomIntVariable ("pg_gvm.host_cache_size",
+                           "Number of host counts kept in shared memory.",
+                           "Only used if pg-gvm is loaded via"
+                           " shared_preload_libraries. 0 disables the cache.",
+                           &host_cache_size,
+                           1024, 0, 1024 * 1024,
+                           PGC_POSTMASTER, 0,
+                           NULL, NULL, NULL);
+}
+
+/**
+ * @brief Request the shared memory and lock of the cache.
+ */
+void
+host_cache_shmem_request_x (void)
+{
+  if (host_cache_size <= 0)
+    return;
+
+  RequestAddinShmemSpace (add_size (MAXALIGN (sizeof (host_cache_shared_x)),
+                                    hash_estimate_size
+                                     (host_cache_size,
+                                      sizeof (host_cache_entry_x))));
+  RequestNamedLWLockTranche (HOST_CACHE_TRANCHE, 1);
+}
+
+/**
+ * @brief Attach to or initialize the shared memory of the cache.
+ */
+void
+host_cache_shmem_startup_x (void)
+{
+  HASHCTL info;
+  bool found;
+
+  if (host_cache_size <= 0)
+    return;
+
+  LWLockAcquire (AddinShmemInitLock, LW_EXCLUSIVE);
+
+  host_cache = ShmemInitStruct ("pg-gvm host cache",
+                                sizeof (host_cache_shared_x), &found);
+  if (found == false)
+    {
+      host_cache->lock = &(GetNamedLWLockTranche (HOST_CACHE_TRANCHE))->lock;
+      dlist_init (&host_cache->lru);
+      host_cache->entries = 0;
+      pg_atomic_init_u64 (&host_cache->hits, 0);
+      pg_atomic_init_u64 (&host_cache->misses, 0);
+      pg_atomic_init_u64 (&host_cache->evictions, 0);
+    }
+
+  memset (&info, 0, sizeof (info));
+  info.keysize = sizeof (host_cache_key_x);
+  info.entrysize = sizeof (host_cache_entry_x);
+  host_cache_table = ShmemInitHash ("pg-gvm host cache table",
+                                    host_cache_size, host_cache_size,
+                                    &info, HASH_ELEM | HASH_BLOBS);
+
+  LWLockRelease (AddinShmemInitLock);
+}
+
+/**
+ * @brief Build the key of a cache entry.
+ *
+ * @param[out] key          The key.
+ * @param[in]  hosts        String describing hosts.
+ * @param[in]  hosts_len    Length of the hosts.
+ * @param[in]  exclude      String describing hosts excluded from given set.
+ * @param[in]  exclude_len  Length of the excluded hosts.
+ * @param[in]  max_hosts    Max hosts.
+ */
+static void
+host_cache_make_key_x (host_cache_key_x *key, const char *hosts,
+                       size_t hosts_len, const char *exclude,
+                       size_t exclude_len, int max_hosts)
+{
+  // Zero the padding too, the key is compared as a whole.
+  memset (key, 0, sizeof (*key));
+  key->hosts_len = hosts_len;
+  key->exclude_len = exclude_len;
+  key->hosts_hash = DatumGetUInt64 (hash_any_extended
+                                     ((const unsigned char *) hosts,
+                                      key->hosts_len, 0));
+  key->exclude_hash = DatumGetUInt64 (hash_any_extended
+                                       ((const unsigned char *) exclude,
+                                        key->exclude_len, 0));
+  key->max_hosts = max_hosts;
+}
+
+/**
+ * @brief Look up a host count in the cache.
+ *
+ * @param[in]  hosts        String describing hosts.
+ * @param[in]  hosts_len    Length of the hosts.
+ * @param[in]  exclude      String describing hosts excluded from given set.
+ * @param[in]  exclude_len  Length of the excluded hosts.
+ * @param[in]  max_hosts    Max hosts.
+ * @param[out] count        The cached count.
+ *
+ * @return 1 if the count was found, 0 otherwise.
+ */
+int
+host_cache_lookup_x (const char *hosts, size_t hosts_len, const char *exclude,
+                     size_t exclude_len, int max_hosts, int *count)
+{
+  host_cache_key_x key;
+  host_cache_entry_x *entry;
+
+  if (host_cache == NULL)
+    return 0;
+
+  host_cache_make_key_x (&key, hosts, hosts_len, exclude, exclude_len,
+                         max_hosts);
+
+  // Shared, because a hit only marks the entry.  The flag is read first, so
+  //  that repeated hits do not write to the entry.
+  LWLockAcquire (host_cache->lock, LW_SHARED);
+  entry = hash_search (host_cache_table, &key, HASH_FIND, NULL);
+  if (entry)
+    {
+      *count = entry->count;
+      if (pg_atomic_read_u32 (&entry->referenced) == 0)
+        pg_atomic_write_u32 (&entry->referenced, 1);
+    }
+  LWLockRelease (host_cache->lock);
+
+  if (entry)
+    {
+      pg_atomic_fetch_add_u64 (&host_cache->hits, 1);
+      return 1;
+    }
+  pg_atomic_fetch_add_u64 (&host_cache->misses, 1);
+  return 0;
+}
+
+/**
+ * @brief Store a host count in the cache.
+ *
+ * If the cache is full, evicts the oldest entry that was not hit since it
+ *  was stored or last given a second chance.  Entries that were hit are
+ *  moved to the head of the list instead.
+ *
+ * @param[in]  hosts        String describing hosts.
+ * @param[in]  hosts_len    Length of the hosts.
+ * @param[in]  exclude      String describing hosts excluded from given set.
+ * @param[in]  exclude_len  Length of the excluded hosts.
+ * @param[in]  max_hosts    Max hosts.
+ * @param[in]  count        The count.
+ */
+void
+host_cache_store_x (const char *hosts, size_t hosts_len, const char *exclude,
+                    size_t exclude_len, int max_hosts, int count)
+{
+  host_cache_key_x key;
+  host_cache_entry_x *entry;
+  bool found;
+
+  if (host_cache == NULL)
+    return;
+
+  host_cache_make_key_x (&key, hosts, hosts_len, exclude, exclude_len,
+                         max_hosts);
+
+  LWLockAcquire (host_cache->lock, LW_EXCLUSIVE);
+
+  entry = hash_search (host_cache_table, &key, HASH_FIND, NULL);
+  if (entry == NULL && host_cache->entries >= host_cache_size)
+    {
+      host_cache_entry_x *oldest;
+
+      // Ends after one pass at most, since the flags are cleared.
+      for (;;)
+        {
+          oldest = dlist_tail_element (host_cache_entry_x, lru_node,
+                                       &host_cache->lru);
+          if (pg_atomic_read_u32 (&oldest->referenced) == 0)
+            break;
+          pg_atomic_write_u32 (&oldest->referenced, 0);
+          dlist_move_head (&host_cache->lru, &oldest->lru_node);
+        }
+      dlist_delete (&oldest->lru_node);
+      hash_search (host_cache_table, &oldest->key, HASH_REMOVE, NULL);
+      host_cache->entries--;
+      pg_atomic_fetch_add_u64 (&host_cache->evictions, 1);
+    }
+
+  if (entry == NULL)
+    {
+      entry = hash_search (host_cache_table, &key, HASH_ENTER_NULL, &found);
+      if (entry)
+        {
+          pg_atomic_init_u32 (&entry->referenced, 0);
+          dlist_push_head (&host_cache->lru, &entry->lru_node);
+          host_cache->entries++;
+        }
+    }
+  else
+    {
+      pg_atomic_write_u32 (&entry->referenced, 0);
+      dlist_move_head (&host_cache->lru, &entry->lru_node);
+    }
+
+  if (entry)
+    entry->count = count;
+
+  LWLockRelease (host_cache->lock);
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_host_cache_stats);
+
+/**
+ * @brief Return the counters of the host count cache.
+ *
+ * This is a callback for a SQL function without arguments.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_host_cache_stats (PG_FUNCTION_ARGS)
+{
+  TupleDesc tupdesc;
+  Datum values[5];
+  bool nulls[5];
+  int entries;
+
+  if (get_call_result_type (fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+    elog (ERROR, "return type must be a row type");
+  tupdesc = BlessTupleDesc (tupdesc);
+
+  memset (nulls, 0, sizeof (nulls));
+  if (host_cache == NULL)
+    {
+      values[0] = Int64GetDatum (0);
+      values[1] = Int64GetDatum (0);
+      values[2] = Int64GetDatum (0);
+      values[3] = Int32GetDatum (0);
+      values[4] = Int32GetDatum (0);
+    }
+  else
+    {
+      LWLockAcquire (host_cache->lock, LW_SHARED);
+      entries = host_cache->entries;
+      LWLockRelease (host_cache->lock);
+
+      values[0] = Int64GetDatum (pg_atomic_read_u64 (&host_cache->hits));
+      values[1] = Int64GetDatum (pg_atomic_read_u64 (&host_cache->misses));
+      values[2] = Int64GetDatum (pg_atomic_read_u64 (&host_cache->evictions));
+      values[3] = Int32GetDatum (entries);
+      values[4] = Int32GetDatum (host_cache_size);
+    }
+
+  PG_RETURN_DATUM (HeapTupleGetDatum (heap_form_tuple (tupdesc, values,
+                                                       nulls)));
+}
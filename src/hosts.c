@@ -19,156 +19,1210 @@
 /**
  * @file hosts.c
  *
- * @brief This file defines functions that are available via the PostgreSQL
- * @brief extension
+ * @brief Implements host functions for the GVM PostgreSQL Extension.
  */
 
 #include "hosts.h"
 
 #include "postgres.h"
-#include "fmgr.h"
-#include "executor/spi.h"
+#include "miscadmin.h"
 #include "glib.h"
 
-#include <gvm/base/hosts.h>
+#include <arpa/inet.h>
 
+/**
+ * @brief Longest hosts element that may be an IPv6 address or range.
+ */
+#define HOSTS_ADDRESS_MAX (2 * INET6_ADDRSTRLEN + 2)
 
 /**
- * @brief Create a string from a portion of text.
+ * @brief Longest hostname.
+ */
+#define HOSTS_NAME_MAX 255
+
+/**
+ * @brief Largest saturated number of hosts.
+ */
+#define HOSTS_SATURATED UINT64_MAX
+
+/**
+ * @brief Compare two addresses.
  *
- * @param[in]  text_arg  Text.
- * @param[in]  length    Length to create.
+ * @param[in]  one  First address.
+ * @param[in]  two  Second address.
  *
- * @return Freshly allocated string.
+ * @return Less than, equal to or greater than 0 like strcmp.
  */
-static char *
-textndup (text *text_arg, int length)
+static int
+hosts_address_compare_x (const hosts_address_x *one,
+                         const hosts_address_x *two)
 {
-  char *ret;
-  ret = palloc (length + 1);
-  memcpy (ret, VARDATA (text_arg), length);
-  ret[length] = 0;
-  return ret;
+  int high, low;
+
+  // Compare both halves without branches, the high half decides unless it
+  //  is equal.  Sorting and searching IPv6 ranges is dominated by this.
+  high = (one->high > two->high) - (one->high < two->high);
+  low = (one->low > two->low) - (one->low < two->low);
+  return 2 * high + low;
+}
+
+/**
+ * @brief Get the number of addresses from first to last, saturated.
+ *
+ * @param[in]  first  First address.
+ * @param[in]  last   Last address, not before first.
+ *
+ * @return The number of addresses.
+ */
+static uint64_t
+hosts_address_size_x (const hosts_address_x *first,
+                      const hosts_address_x *last)
+{
+  uint64_t high, low;
+
+  low = last->low - first->low;
+  high = last->high - first->high - (last->low < first->low ? 1 : 0);
+  if (high || low == HOSTS_SATURATED)
+    return HOSTS_SATURATED;
+  return low + 1;
+}
+
+/**
+ * @brief Add two numbers of hosts, saturating at HOSTS_SATURATED.
+ *
+ * @param[in]  one  First number.
+ * @param[in]  two  Second number.
+ *
+ * @return The sum.
+ */
+static uint64_t
+hosts_add_x (uint64_t one, uint64_t two)
+{
+  if (one > HOSTS_SATURATED - two)
+    return HOSTS_SATURATED;
+  return one + two;
+}
+
+/**
+ * @brief Increment an address.
+ *
+ * @param[in,out]  address  The address.
+ */
+static void
+hosts_address_increment_x (hosts_address_x *address)
+{
+  address->low++;
+  if (address->low == 0)
+    address->high++;
 }
 
 /**
- * @brief Get the maximum number of hosts.
+ * @brief Decrement an address.
  *
- * @return The maximum number of hosts.
+ * @param[in,out]  address  The address.
+ */
+static void
+hosts_address_decrement_x (hosts_address_x *address)
+{
+  if (address->low == 0)
+    address->high--;
+  address->low--;
+}
+
+/**
+ * @brief Get whether a range is the whole IPv6 address space.
+ *
+ * @param[in]  first  First address.
+ * @param[in]  last   Last address.
+ *
+ * @return 1 if the range has all 2^128 addresses, 0 otherwise.
  */
 static int
-get_max_hosts_x ()
+hosts_address_whole_x (const hosts_address_x *first,
+                       const hosts_address_x *last)
 {
-  int ret;
-  int max_hosts = 4095;
-  SPI_connect ();
-  ret = SPI_exec ("SELECT coalesce ((SELECT value FROM meta"
-                  "                  WHERE name = 'max_hosts'),"
-                  "                 '4095');", /* Same as MANAGE_MAX_HOSTS. */
-                  1); /* Max 1 row returned. */
-  if (SPI_processed > 0 && ret > 0 && SPI_tuptable != NULL)
+  return (first->high | first->low) == 0
+         && (last->high & last->low) == UINT64_MAX;
+}
+
+/**
+ * @brief Get the number of addresses from first to last as 128 bit number.
+ *
+ * @param[in]   first  First address.
+ * @param[in]   last   Last address, not before first.
+ * @param[out]  size   The number of addresses, saturated at 2^128 - 1 for
+ *                     the whole IPv6 address space.
+ */
+static void
+hosts_address_size_wide_x (const hosts_address_x *first,
+                           const hosts_address_x *last,
+                           hosts_address_x *size)
+{
+  size->low = last->low - first->low;
+  size->high = last->high - first->high - (last->low < first->low);
+  if (size->high != UINT64_MAX || size->low != UINT64_MAX)
+    hosts_address_increment_x (size);
+}
+
+/**
+ * @brief Add a 128 bit number of hosts, saturating at 2^128 - 1.
+ *
+ * @param[in,out]  sum   The sum.
+ * @param[in]      size  The number to add.
+ */
+static void
+hosts_address_add_x (hosts_address_x *sum, const hosts_address_x *size)
+{
+  uint64_t low, high, carry;
+
+  low = sum->low + size->low;
+  carry = low < sum->low;
+  high = sum->high + size->high;
+  if (high < sum->high || high + carry < high)
+    {
+      sum->high = sum->low = UINT64_MAX;
+      return;
+    }
+  sum->high = high + carry;
+  sum->low = low;
+}
+
+/**
+ * @brief Subtract a 128 bit number of hosts.
+ *
+ * @param[in,out]  one  The number to subtract from.
+ * @param[in]      two  The number to subtract, not more than one.
+ */
+static void
+hosts_address_subtract_x (hosts_address_x *one, const hosts_address_x *two)
+{
+  uint64_t borrow;
+
+  borrow = one->low < two->low;
+  one->low -= two->low;
+  one->high -= two->high + borrow;
+}
+
+/**
+ * @brief Convert an IPv6 address to a number.
+ *
+ * @param[in]   bytes    The 16 bytes of the address in network order.
+ * @param[out]  address  The number.
+ */
+static void
+hosts_address_from_ipv6_x (const unsigned char *bytes,
+                           hosts_address_x *address)
+{
+  int index;
+
+  address->high = 0;
+  address->low = 0;
+  for (index = 0; index < 8; index++)
+    {
+      address->high = (address->high << 8) | bytes[index];
+      address->low = (address->low << 8) | bytes[index + 8];
+    }
+}
+
+/**
+ * @brief Parse an IPv4 address in dotted decimal notation.
+ *
+ * Like inet_pton, but without copying the string.
+ *
+ * @param[in]   start    Start of the address.
+ * @param[in]   length   Length of the address.
+ * @param[out]  address  The parsed address.
+ *
+ * @return 0 on success, -1 if it is no IPv4 address.
+ */
+static int
+hosts_parse_ipv4_x (const char *start, size_t length, uint32_t *address)
+{
+  uint32_t value;
+  size_t index;
+  int part;
+
+  value = 0;
+  index = 0;
+  for (part = 0; part < 4; part++)
     {
-      char *cell;
+      uint32_t octet;
+      size_t digits;
 
-      cell = SPI_getvalue (SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 1);
-      elog (DEBUG1, "cell: %s", cell);
-      if (cell)
-        max_hosts = atoi (cell);
+      if (part)
+        {
+          if (index >= length || start[index] != '.')
+            return -1;
+          index++;
+        }
+
+      octet = 0;
+      digits = 0;
+      while (index < length && g_ascii_isdigit (start[index]))
+        {
+          // No leading zeros, like inet_pton.
+          if (digits && octet == 0)
+            return -1;
+          octet = octet * 10 + (start[index] - '0');
+          if (octet > 255)
+            return -1;
+          digits++;
+          index++;
+        }
+      if (digits == 0)
+        return -1;
+      value = (value << 8) | octet;
     }
-  elog (DEBUG1, "done");
-  SPI_finish ();
 
-  return max_hosts;
+  if (index != length)
+    return -1;
+  *address = value;
+  return 0;
 }
 
 /**
- * @brief Define function for Postgres.
+ * @brief Parse an IPv6 address.
+ *
+ * @param[in]   start    Start of the address.
+ * @param[in]   length   Length of the address.
+ * @param[out]  address  The parsed address.
+ *
+ * @return 0 on success, -1 if it is no IPv6 address.
  */
-PG_FUNCTION_INFO_V1 (sql_max_hosts);
+static int
+hosts_parse_ipv6_x (const char *start, size_t length,
+                    hosts_address_x *address)
+{
+  char buffer[INET6_ADDRSTRLEN];
+  unsigned char bytes[16];
+
+  if (length == 0 || length >= sizeof (buffer)
+      || memchr (start, ':', length) == NULL)
+    return -1;
 
+  memcpy (buffer, start, length);
+  buffer[length] = '\0';
+  if (inet_pton (AF_INET6, buffer, bytes) != 1)
+    return -1;
+
+  hosts_address_from_ipv6_x (bytes, address);
+  return 0;
+}
 
 /**
- * @brief Return number of hosts.
+ * @brief Parse an unsigned number.
  *
- * This is a callback for a SQL function of two arguments.
+ * @param[in]   start    Start of the number.
+ * @param[in]   length   Length of the number.
+ * @param[in]   base     10 or 16.
+ * @param[in]   max      Largest allowed value.
+ * @param[out]  number   The parsed number.
  *
- * @return Postgres Datum.
+ * @return 0 on success, -1 if it is no number or larger than max.
  */
-Datum
-sql_max_hosts (PG_FUNCTION_ARGS)
+static int
+hosts_parse_number_x (const char *start, size_t length, int base,
+                      unsigned int max, unsigned int *number)
 {
-  if (PG_ARGISNULL (0))
-    PG_RETURN_INT32 (0);
+  unsigned int value;
+  size_t index;
+
+  if (length == 0)
+    return -1;
+
+  value = 0;
+  for (index = 0; index < length; index++)
+    {
+      int digit;
+
+      digit = g_ascii_xdigit_value (start[index]);
+      if (digit < 0 || digit >= base)
+        return -1;
+      value = value * base + digit;
+      if (value > max)
+        return -1;
+    }
+
+  *number = value;
+  return 0;
+}
+
+/**
+ * @brief Get whether a string is a valid hostname.
+ *
+ * @param[in]  start   Start of the hostname.
+ * @param[in]  length  Length of the hostname.
+ *
+ * @return 1 if valid, 0 otherwise.
+ */
+static int
+hosts_is_name_x (const char *start, size_t length)
+{
+  size_t index;
+
+  if (length == 0 || length > HOSTS_NAME_MAX
+      || g_ascii_isalnum (start[0]) == FALSE)
+    return 0;
+
+  for (index = 1; index < length; index++)
+    if (g_ascii_isalnum (start[index]) == FALSE && start[index] != '-'
+        && start[index] != '_' && start[index] != '.')
+      return 0;
+
+  return 1;
+}
+
+/**
+ * @brief Set a range to the hosts of a CIDR block.
+ *
+ * The network and broadcast addresses are left out, except for blocks of
+ *  one or two addresses.
+ *
+ * @param[in]   network  An address in the block.
+ * @param[in]   bits     Number of bits of an address, 32 or 128.
+ * @param[in]   prefix   Length of the prefix, from 1 to bits.
+ * @param[out]  range    The range.
+ */
+static void
+hosts_range_cidr_x (const hosts_address_x *network, int bits, int prefix,
+                    hosts_range_x *range)
+{
+  hosts_address_x mask;
+  int host_bits;
+
+  // Mask of the host part of the address.
+  host_bits = bits - prefix;
+  if (host_bits >= 64)
+    {
+      mask.low = UINT64_MAX;
+      mask.high = host_bits == 128 ? UINT64_MAX
+                  : (UINT64_C (1) << (host_bits - 64)) - 1;
+    }
   else
     {
-      text *hosts_arg;
-      char *hosts, *exclude;
-      int ret, max_hosts;
+      mask.high = 0;
+      mask.low = host_bits ? (UINT64_C (1) << host_bits) - 1 : 0;
+    }
+
+  range->first.high = network->high & ~mask.high;
+  range->first.low = network->low & ~mask.low;
+  range->last.high = network->high | mask.high;
+  range->last.low = network->low | mask.low;
+
+  if (host_bits > 1)
+    {
+      hosts_address_increment_x (&range->first);
+      hosts_address_decrement_x (&range->last);
+    }
+}
+
+/**
+ * @brief Parse an address range like 192.168.0.1-192.168.0.20, 192.168.0.1-20
+ *        or the IPv6 equivalents.
+ *
+ * @param[in]   start   Start of the element.
+ * @param[in]   length  Length of the element.
+ * @param[in]   dash    The dash in the element.
+ * @param[out]  range   The range.
+ *
+ * @return 0 on success, -1 if the element is no valid range.
+ */
+static int
+hosts_parse_range_x (const char *start, size_t length, const char *dash,
+                     hosts_range_x *range)
+{
+  const char *end;
+  size_t first_length;
+  unsigned int number;
+  uint32_t first4, last4;
+
+  first_length = dash - start;
+  end = dash + 1;
+  length -= first_length + 1;
+
+  if (hosts_parse_ipv4_x (start, first_length, &first4) == 0)
+    {
+      if (hosts_parse_ipv4_x (end, length, &last4) == 0)
+        ;
+      else if (hosts_parse_number_x (end, length, 10, 255, &number) == 0)
+        last4 = (first4 & ~UINT32_C (0xff)) | number;
+      else
+        return -1;
+      if (last4 < first4)
+        return -1;
+      range->type = HOSTS_RANGE_IPV4_X;
+      range->first.high = range->last.high = 0;
+      range->first.low = first4;
+      range->last.low = last4;
+      return 0;
+    }
 
-      hosts_arg = PG_GETARG_TEXT_P (0);
-      hosts = textndup (hosts_arg, VARSIZE (hosts_arg) - VARHDRSZ);
-      if (PG_ARGISNULL (1))
+  if (hosts_parse_ipv6_x (start, first_length, &range->first))
+    return -1;
+  if (hosts_parse_ipv6_x (end, length, &range->last) == 0)
+    ;
+  else if (hosts_parse_number_x (end, length, 16, 0xffff, &number) == 0)
+    {
+      range->last = range->first;
+      range->last.low = (range->last.low & ~UINT64_C (0xffff)) | number;
+    }
+  else
+    return -1;
+  if (hosts_address_compare_x (&range->first, &range->last) > 0)
+    return -1;
+  range->type = HOSTS_RANGE_IPV6_X;
+  return 0;
+}
+
+/**
+ * @brief Parse a single element of a hosts string.
+ *
+ * @param[in]   start   Start of the element, without surrounding spaces.
+ * @param[in]   length  Length of the element.
+ * @param[out]  range   The range.
+ *
+ * @return 0 on success, -1 if the element is invalid.
+ */
+static int
+hosts_parse_element_x (const char *start, size_t length, hosts_range_x *range)
+{
+  const char *separator;
+  uint32_t address4;
+
+  range->name = NULL;
+  range->name_length = 0;
+
+  if (length < HOSTS_ADDRESS_MAX)
+    {
+      if (hosts_parse_ipv4_x (start, length, &address4) == 0)
         {
-          exclude = palloc (1);
-          exclude[0] = 0;
+          range->type = HOSTS_RANGE_IPV4_X;
+          range->first.high = 0;
+          range->first.low = address4;
+          range->last = range->first;
+          return 0;
         }
-      else
+
+      if (hosts_parse_ipv6_x (start, length, &range->first) == 0)
+        {
+          range->type = HOSTS_RANGE_IPV6_X;
+          range->last = range->first;
+          return 0;
+        }
+
+      separator = memchr (start, '/', length);
+      if (separator)
+        {
+          hosts_address_x network;
+          size_t address_length;
+          unsigned int prefix;
+
+          address_length = separator - start;
+          if (hosts_parse_ipv4_x (start, address_length, &address4) == 0)
+            {
+              if (hosts_parse_number_x (separator + 1,
+                                        length - address_length - 1,
+                                        10, 32, &prefix)
+                  || prefix == 0)
+                return -1;
+              network.high = 0;
+              network.low = address4;
+              range->type = HOSTS_RANGE_IPV4_X;
+              hosts_range_cidr_x (&network, 32, prefix, range);
+              return 0;
+            }
+          if (hosts_parse_ipv6_x (start, address_length, &network) == 0)
+            {
+              if (hosts_parse_number_x (separator + 1,
+                                        length - address_length - 1,
+                                        10, 128, &prefix)
+                  || prefix == 0)
+                return -1;
+              range->type = HOSTS_RANGE_IPV6_X;
+              hosts_range_cidr_x (&network, 128, prefix, range);
+              return 0;
+            }
+          return -1;
+        }
+
+      // Hostnames may contain dashes, too.
+      separator = memchr (start, '-', length);
+      if (separator && hosts_parse_range_x (start, length, separator, range)
+                       == 0)
+        return 0;
+    }
+
+  if (hosts_is_name_x (start, length) == 0)
+    return -1;
+
+  range->type = HOSTS_RANGE_NAME_X;
+  range->name = start;
+  range->name_length = length;
+  return 0;
+}
+
+/**
+ * @brief Get the arena space needed to parse a hosts string.
+ *
+ * @param[in]  hosts_str  The hosts string.
+ * @param[in]  length     Length of the hosts string.
+ *
+ * @return Number of bytes, enough for one range per element.
+ */
+size_t
+hosts_parse_space_x (const char *hosts_str, size_t length)
+{
+  size_t elements, index;
+
+  elements = 1;
+  for (index = 0; index < length; index++)
+    if (hosts_str[index] == ',' || hosts_str[index] == '\n')
+      elements++;
+
+  return elements * sizeof (hosts_range_x) + MAXIMUM_ALIGNOF;
+}
+
+/**
+ * @brief Initialise an arena.
+ *
+ * @param[out]  arena  The arena.
+ * @param[in]   base   Memory of the arena.
+ * @param[in]   size   Size of the memory.
+ */
+void
+hosts_arena_init_x (hosts_arena_x *arena, void *base, size_t size)
+{
+  arena->base = base;
+  arena->size = size;
+  arena->used = 0;
+}
+
+/**
+ * @brief Parse a hosts string into a list of ranges.
+ *
+ * The string is scanned once.  Every element becomes a single range in the
+ *  arena, so CIDR blocks and ranges are never expanded and nothing is
+ *  allocated.  Hostnames point into the hosts string, which must outlive the
+ *  list.  Like with gvm_hosts_new_with_max the elements are separated by
+ *  commas or newlines and the limit applies to the hosts before duplicates
+ *  are removed.  Interrupts and the number of ranges are checked for each
+ *  element, so that a huge hosts string is stopped while it is parsed.
+ *
+ * @param[in]   hosts_str   The hosts string, need not be terminated.
+ * @param[in]   length      Length of the hosts string.
+ * @param[in]   max_hosts   Maximum number of hosts, 0 or less for no limit.
+ * @param[in]   max_ranges  Maximum number of ranges, 0 or less for no limit.
+ * @param[in]   arena       Arena for the ranges, see hosts_parse_space_x.
+ * @param[out]  list        The ranges.
+ *
+ * @return 0 on success, HOSTS_PARSE_INVALID_X, HOSTS_PARSE_TOO_MANY_X,
+ *         HOSTS_PARSE_NO_SPACE_X or HOSTS_PARSE_TOO_MANY_RANGES_X on error.
+ */
+int
+hosts_parse_x (const char *hosts_str, size_t length, int max_hosts,
+               int max_ranges, hosts_arena_x *arena, hosts_list_x *list)
+{
+  const char *element, *end;
+  size_t start;
+
+  start = TYPEALIGN (MAXIMUM_ALIGNOF, (uintptr_t) (arena->base + arena->used))
+          - (uintptr_t) arena->base;
+  list->ranges = (hosts_range_x *) (arena->base + start);
+  list->count = 0;
+  list->hosts = 0;
+  list->normalized = 0;
+
+  element = hosts_str;
+  end = hosts_str + length;
+  while (element < end)
+    {
+      const char *next;
+      size_t element_length;
+
+      CHECK_FOR_INTERRUPTS ();
+
+      next = element;
+      while (next < end && *next != ',' && *next != '\n')
+        next++;
+      element_length = next - element;
+
+      while (element_length && g_ascii_isspace (*element))
+        {
+          element++;
+          element_length--;
+        }
+      while (element_length && g_ascii_isspace (element[element_length - 1]))
+        element_length--;
+
+      if (element_length)
+        {
+          hosts_range_x *range;
+
+          if (max_ranges > 0 && list->count >= (size_t) max_ranges)
+            return HOSTS_PARSE_TOO_MANY_RANGES_X;
+
+          if (start + (list->count + 1) * sizeof (hosts_range_x)
+              > arena->size)
+            return HOSTS_PARSE_NO_SPACE_X;
+
+          range = &list->ranges[list->count];
+          if (hosts_parse_element_x (element, element_length, range))
+            return HOSTS_PARSE_INVALID_X;
+          list->count++;
+
+          if (range->type == HOSTS_RANGE_NAME_X)
+            list->hosts = hosts_add_x (list->hosts, 1);
+          else
+            list->hosts = hosts_add_x (list->hosts,
+                                       hosts_address_size_x (&range->first,
+                                                             &range->last));
+          if (max_hosts > 0 && list->hosts > (uint64_t) max_hosts)
+            return HOSTS_PARSE_TOO_MANY_X;
+        }
+
+      element = next + 1;
+    }
+
+  arena->used = start + list->count * sizeof (hosts_range_x);
+  return 0;
+}
+
+/**
+ * @brief Compare two ranges for sorting.
+ *
+ * Ranges are sorted by type, addresses by their first address and hostnames
+ *  case insensitively.
+ *
+ * @param[in]  one_arg  First range.
+ * @param[in]  two_arg  Second range.
+ *
+ * @return Less than, equal to or greater than 0 like strcmp.
+ */
+static int
+hosts_range_compare_x (const void *one_arg, const void *two_arg)
+{
+  const hosts_range_x *one, *two;
+  int ret;
+
+  one = one_arg;
+  two = two_arg;
+  if (one->type != two->type)
+    return one->type < two->type ? -1 : 1;
+
+  if (one->type == HOSTS_RANGE_NAME_X)
+    {
+      ret = g_ascii_strncasecmp (one->name, two->name,
+                                 MIN (one->name_length, two->name_length));
+      if (ret)
+        return ret;
+      if (one->name_length != two->name_length)
+        return one->name_length < two->name_length ? -1 : 1;
+      return 0;
+    }
+
+  ret = hosts_address_compare_x (&one->first, &two->first);
+  if (ret)
+    return ret;
+  return hosts_address_compare_x (&one->last, &two->last);
+}
+
+/**
+ * @brief Sort the ranges of a list and merge overlapping ranges.
+ *
+ * Afterwards the list has no duplicates, the address ranges of each type
+ *  are disjoint and ascending and the hostnames are sorted case
+ *  insensitively, so that hosts_list_contains_x finds any host with a binary
+ *  search.  Targets with many hostnames are sorted once instead of being
+ *  compared name by name for every lookup.
+ *
+ * @param[in,out]  list  The list.
+ */
+void
+hosts_list_normalize_x (hosts_list_x *list)
+{
+  size_t index, count;
+
+  if (list->normalized)
+    return;
+  list->normalized = 1;
+  if (list->count < 2)
+    return;
+
+  qsort (list->ranges, list->count, sizeof (hosts_range_x),
+         hosts_range_compare_x);
+
+  count = 1;
+  for (index = 1; index < list->count; index++)
+    {
+      hosts_range_x *current, *range;
+
+      current = &list->ranges[count - 1];
+      range = &list->ranges[index];
+      if (current->type == range->type)
+        {
+          if (range->type == HOSTS_RANGE_NAME_X)
+            {
+              if (hosts_range_compare_x (current, range) == 0)
+                continue;
+            }
+          else
+            {
+              hosts_address_x next;
+
+              // Merge if the range starts at most one after the current.
+              next = current->last;
+              hosts_address_increment_x (&next);
+              if (hosts_address_compare_x (&range->first, &next) <= 0
+                  || (next.high == 0 && next.low == 0))
+                {
+                  if (hosts_address_compare_x (&range->last, &current->last)
+                      > 0)
+                    current->last = range->last;
+                  continue;
+                }
+            }
+        }
+      list->ranges[count++] = *range;
+    }
+  list->count = count;
+}
+
+/**
+ * @brief Get whether an excluded range lies completely before a range.
+ *
+ * @param[in]  excluded  The excluded range.
+ * @param[in]  range     The range.
+ *
+ * @return 1 if the excluded range is before the range, 0 otherwise.
+ */
+static int
+hosts_range_before_x (const hosts_range_x *excluded,
+                      const hosts_range_x *range)
+{
+  if (excluded->type != range->type)
+    return excluded->type < range->type;
+  if (range->type == HOSTS_RANGE_NAME_X)
+    return hosts_range_compare_x (excluded, range) < 0;
+  return hosts_address_compare_x (&excluded->last, &range->first) < 0;
+}
+
+/**
+ * @brief Count the distinct hosts of a list that are not excluded.
+ *
+ * Both lists are normalized, then the excluded ranges are subtracted from
+ *  the ranges of the same type in a single pass over both lists, so that no
+ *  range is expanded.  Hostnames are compared without resolving them.  The
+ *  count is a 128 bit number, so that IPv6 networks are counted exactly.
+ *
+ * @param[in,out]  list     The hosts.
+ * @param[in,out]  exclude  The excluded hosts, may be NULL.
+ * @param[out]     count    Number of hosts, saturated at 2^128 - 1.
+ */
+void
+hosts_list_count_wide_x (hosts_list_x *list, hosts_list_x *exclude,
+                         hosts_address_x *count)
+{
+  size_t index, exclude_index;
+
+  hosts_list_normalize_x (list);
+  if (exclude)
+    hosts_list_normalize_x (exclude);
+
+  count->high = count->low = 0;
+  exclude_index = 0;
+  for (index = 0; index < list->count; index++)
+    {
+      const hosts_range_x *range;
+      hosts_address_x size;
+      size_t overlap_index;
+      int whole;
+
+      range = &list->ranges[index];
+      size.high = 0;
+      size.low = 1;
+      if (range->type != HOSTS_RANGE_NAME_X)
+        hosts_address_size_wide_x (&range->first, &range->last, &size);
+      // The whole address space has one more address than fits.
+      whole = hosts_address_whole_x (&range->first, &range->last);
+
+      if (exclude == NULL)
         {
-          text *exclude_arg;
-          exclude_arg = PG_GETARG_TEXT_P (1);
-          exclude = textndup (exclude_arg, VARSIZE (exclude_arg) - VARHDRSZ);
+          hosts_address_add_x (count, &size);
+          continue;
         }
 
-      max_hosts = get_max_hosts_x ();
-      ret = manage_count_hosts_max (hosts, exclude, max_hosts);
-      pfree (hosts);
-      pfree (exclude);
-      PG_RETURN_INT32 (ret);
+      // The ranges are ascending, so skipped excluded ranges are done.
+      while (exclude_index < exclude->count
+             && hosts_range_before_x (&exclude->ranges[exclude_index], range))
+        exclude_index++;
+
+      for (overlap_index = exclude_index;
+           overlap_index < exclude->count && (size.high || size.low);
+           overlap_index++)
+        {
+          const hosts_range_x *excluded;
+          const hosts_address_x *first, *last;
+          hosts_address_x overlap;
+
+          excluded = &exclude->ranges[overlap_index];
+          if (excluded->type != range->type)
+            break;
+          if (range->type == HOSTS_RANGE_NAME_X)
+            {
+              if (hosts_range_compare_x (excluded, range) == 0)
+                size.low = 0;
+              break;
+            }
+          if (hosts_address_compare_x (&excluded->first, &range->last) > 0)
+            break;
+
+          first = hosts_address_compare_x (&excluded->first, &range->first)
+                  > 0 ? &excluded->first : &range->first;
+          last = hosts_address_compare_x (&excluded->last, &range->last) < 0
+                 ? &excluded->last : &range->last;
+          hosts_address_size_wide_x (first, last, &overlap);
+          if (whole && hosts_address_whole_x (first, last))
+            size.high = size.low = 0;
+          else
+            {
+              hosts_address_subtract_x (&size, &overlap);
+              if (whole)
+                hosts_address_increment_x (&size);
+            }
+          whole = 0;
+        }
+
+      hosts_address_add_x (count, &size);
     }
 }
 
+/**
+ * @brief Count the distinct hosts of a list that are not excluded.
+ *
+ * @param[in,out]  list     The hosts.
+ * @param[in,out]  exclude  The excluded hosts, may be NULL.
+ *
+ * @return Number of hosts, saturated at UINT64_MAX.
+ */
+uint64_t
+hosts_list_count_x (hosts_list_x *list, hosts_list_x *exclude)
+{
+  hosts_address_x count;
+
+  hosts_list_count_wide_x (list, exclude, &count);
+  return count.high ? HOSTS_SATURATED : count.low;
+}
 
 /**
- * @brief Define function for Postgres.
+ * @brief Get the arena space needed to subtract a list from another.
+ *
+ * @param[in]  list     The hosts.
+ * @param[in]  exclude  The excluded hosts, may be NULL.
+ *
+ * @return Number of bytes.
  */
-PG_FUNCTION_INFO_V1 (sql_hosts_contains);
+size_t
+hosts_subtract_space_x (const hosts_list_x *list, const hosts_list_x *exclude)
+{
+  return (list->count + (exclude ? exclude->count : 0) + 1)
+         * sizeof (hosts_range_x) + MAXIMUM_ALIGNOF;
+}
 
 /**
- * @brief Return if argument 1 matches regular expression in argument 2.
+ * @brief Subtract the excluded hosts from a list into a new list.
+ *
+ * Both lists are normalized.  Every range is split at the excluded ranges
+ *  inside it, so the result is normalized, too, and has at most as many
+ *  ranges as both lists together.  Hostnames of the result point into the
+ *  hosts string of the list.
  *
- * This is a callback for a SQL function of two arguments.
+ * @param[in,out]  list     The hosts.
+ * @param[in,out]  exclude  The excluded hosts, may be NULL.
+ * @param[in]      arena    Arena for the result, see hosts_subtract_space_x.
+ * @param[out]     result   The hosts that are not excluded.
  *
- * @return Postgres Datum.
+ * @return 0 on success, HOSTS_PARSE_NO_SPACE_X if the arena is too small.
  */
-Datum
-sql_hosts_contains (PG_FUNCTION_ARGS)
+int
+hosts_list_subtract_x (hosts_list_x *list, hosts_list_x *exclude,
+                       hosts_arena_x *arena, hosts_list_x *result)
 {
-  if (PG_ARGISNULL (0) || PG_ARGISNULL (1))
-    PG_RETURN_BOOL (0);
+  size_t index, exclude_index, start;
+
+  hosts_list_normalize_x (list);
+  if (exclude)
+    hosts_list_normalize_x (exclude);
+
+  start = TYPEALIGN (MAXIMUM_ALIGNOF, (uintptr_t) (arena->base + arena->used))
+          - (uintptr_t) arena->base;
+  if (start + (list->count + (exclude ? exclude->count : 0))
+              * sizeof (hosts_range_x)
+      > arena->size)
+    return HOSTS_PARSE_NO_SPACE_X;
+
+  result->ranges = (hosts_range_x *) (arena->base + start);
+  result->count = 0;
+  result->hosts = 0;
+  result->normalized = 1;
+
+  exclude_index = 0;
+  for (index = 0; index < list->count; index++)
+    {
+      const hosts_range_x *range;
+      hosts_address_x cursor;
+      size_t overlap_index;
+      int done;
+
+      range = &list->ranges[index];
+      while (exclude && exclude_index < exclude->count
+             && hosts_range_before_x (&exclude->ranges[exclude_index], range))
+        exclude_index++;
+
+      if (range->type == HOSTS_RANGE_NAME_X)
+        {
+          if (exclude && exclude_index < exclude->count
+              && hosts_range_compare_x (&exclude->ranges[exclude_index],
+                                        range) == 0)
+            continue;
+          result->ranges[result->count++] = *range;
+          result->hosts = hosts_add_x (result->hosts, 1);
+          continue;
+        }
+
+      // Emit the parts of the range between the excluded ranges.
+      cursor = range->first;
+      done = 0;
+      for (overlap_index = exclude_index;
+           exclude && overlap_index < exclude->count && done == 0;
+           overlap_index++)
+        {
+          const hosts_range_x *excluded;
+
+          excluded = &exclude->ranges[overlap_index];
+          if (excluded->type != range->type
+              || hosts_address_compare_x (&excluded->first, &range->last) > 0)
+            break;
+
+          if (hosts_address_compare_x (&excluded->first, &cursor) > 0)
+            {
+              hosts_range_x *part;
+
+              part = &result->ranges[result->count++];
+              *part = *range;
+              part->first = cursor;
+              part->last = excluded->first;
+              hosts_address_decrement_x (&part->last);
+              result->hosts = hosts_add_x (result->hosts,
+                                           hosts_address_size_x
+                                            (&part->first, &part->last));
+            }
+
+          if (hosts_address_compare_x (&excluded->last, &range->last) >= 0)
+            done = 1;
+          else
+            {
+              cursor = excluded->last;
+              hosts_address_increment_x (&cursor);
+            }
+        }
+
+      if (done == 0)
+        {
+          hosts_range_x *part;
+
+          part = &result->ranges[result->count++];
+          *part = *range;
+          part->first = cursor;
+          result->hosts = hosts_add_x (result->hosts,
+                                       hosts_address_size_x (&part->first,
+                                                             &part->last));
+        }
+    }
+
+  arena->used = start + result->count * sizeof (hosts_range_x);
+  return 0;
+}
+
+/**
+ * @brief Set a range to a single address.
+ *
+ * @param[in]   bytes   The address in network order.
+ * @param[in]   length  Length of the address, 4 for IPv4 or 16 for IPv6.
+ * @param[out]  range   The range.
+ */
+void
+hosts_range_from_bytes_x (const unsigned char *bytes, int length,
+                          hosts_range_x *range)
+{
+  range->name = NULL;
+  range->name_length = 0;
+  if (length == 16)
+    {
+      range->type = HOSTS_RANGE_IPV6_X;
+      hosts_address_from_ipv6_x (bytes, &range->first);
+    }
   else
     {
-      text *hosts_arg, *find_host_arg;
-      char *hosts, *find_host;
-      int max_hosts, ret;
+      range->type = HOSTS_RANGE_IPV4_X;
+      range->first.high = 0;
+      range->first.low = ((uint32_t) bytes[0] << 24) | (bytes[1] << 16)
+                         | (bytes[2] << 8) | bytes[3];
+    }
+  range->last = range->first;
+}
 
-      hosts_arg = PG_GETARG_TEXT_P(0);
-      hosts = textndup (hosts_arg, VARSIZE (hosts_arg) - VARHDRSZ);
+/**
+ * @brief Get the bytes of an address in network order.
+ *
+ * @param[in]   address  The address.
+ * @param[in]   length   Length of the address, 4 for IPv4 or 16 for IPv6.
+ * @param[out]  bytes    The address in network order.
+ */
+void
+hosts_address_to_bytes_x (const hosts_address_x *address, int length,
+                          unsigned char *bytes)
+{
+  int index;
 
-      find_host_arg = PG_GETARG_TEXT_P(1);
-      find_host = textndup (find_host_arg, VARSIZE (find_host_arg) - VARHDRSZ);
+  if (length == 16)
+    {
+      for (index = 0; index < 8; index++)
+        {
+          bytes[index] = address->high >> (56 - 8 * index);
+          bytes[index + 8] = address->low >> (56 - 8 * index);
+        }
+      return;
+    }
 
-      max_hosts = get_max_hosts_x ();
+  for (index = 0; index < 4; index++)
+    bytes[index] = address->low >> (24 - 8 * index);
+}
 
-      if (hosts_str_contains ((gchar *) hosts, (gchar *) find_host,
-                              max_hosts))
-        ret = 1;
-      else
-        ret = 0;
+/**
+ * @brief Compare the start of a range with a host.
+ *
+ * @param[in]  range  The range.
+ * @param[in]  host   Range of the host.
+ *
+ * @return Less than, equal to or greater than 0 like strcmp.
+ */
+static int
+hosts_range_compare_start_x (const hosts_range_x *range,
+                             const hosts_range_x *host)
+{
+  if (range->type != host->type || range->type == HOSTS_RANGE_NAME_X)
+    return hosts_range_compare_x (range, host);
+  return hosts_address_compare_x (&range->first, &host->first);
+}
 
-      pfree (hosts);
-      pfree (find_host);
-      PG_RETURN_BOOL (ret);
+/**
+ * @brief Returns whether a single host is in a list.
+ *
+ * Normalized lists are searched with a binary search, others linearly.
+ *
+ * @param[in]  list  The list.
+ * @param[in]  host  Range of the host.
+ *
+ * @return 1 if the host is in the list, 0 otherwise.
+ */
+int
+hosts_list_contains_x (const hosts_list_x *list, const hosts_range_x *host)
+{
+  size_t index;
+
+  if (list->normalized)
+    {
+      size_t low, high;
+
+      // Find the last range starting at or before the host.
+      low = 0;
+      high = list->count;
+      while (low < high)
+        {
+          size_t middle = low + (high - low) / 2;
+
+          if (hosts_range_compare_start_x (&list->ranges[middle], host) <= 0)
+            low = middle + 1;
+          else
+            high = middle;
+        }
+      if (low == 0)
+        return 0;
+
+      index = low - 1;
+      if (list->ranges[index].type != host->type)
+        return 0;
+      if (host->type == HOSTS_RANGE_NAME_X)
+        return hosts_range_compare_x (&list->ranges[index], host) == 0;
+      return hosts_address_compare_x (&host->first,
+                                      &list->ranges[index].last) <= 0;
+    }
+
+  for (index = 0; index < list->count; index++)
+    {
+      const hosts_range_x *range;
+
+      range = &list->ranges[index];
+      if (range->type != host->type)
+        continue;
+      if (range->type == HOSTS_RANGE_NAME_X)
+        {
+          if (hosts_range_compare_x (range, host) == 0)
+            return 1;
+        }
+      else if (hosts_address_compare_x (&range->first, &host->first) <= 0
+               && hosts_address_compare_x (&host->first, &range->last) <= 0)
+        return 1;
     }
+
+  return 0;
+}
+
+/**
+ * @brief Returns whether a host has an equal host in parsed hosts.
+ *
+ * @param[in] list           Parsed hosts to check.
+ * @param[in] find_host_str  The host to find, need not be terminated.
+ * @param[in] length         Length of the host to find.
+ *
+ * @return 1 if host has equal in hosts, 0 otherwise.
+ */
+int
+hosts_contains_x (const hosts_list_x *list, const char *find_host_str,
+                  size_t length)
+{
+  hosts_range_x range;
+  hosts_arena_x arena;
+  hosts_list_x find;
+
+  // Anything with more than one range is no single host anyway.
+  hosts_arena_init_x (&arena, &range, sizeof (range));
+  if (hosts_parse_x (find_host_str, length, 1, 0, &arena, &find)
+      || find.hosts != 1)
+    return 0;
+
+  return hosts_list_contains_x (list, &find.ranges[0]);
+}
+
+/**
+ * @brief Parse a hosts string into an arena allocated with palloc.
+ *
+ * @param[in]   hosts_str  The hosts string.
+ * @param[in]   max_hosts  Maximum number of hosts, 0 or less for no limit.
+ * @param[out]  list       The ranges.
+ *
+ * @return 0 on success, otherwise the error of hosts_parse_x.
+ */
+int
+hosts_parse_alloc_x (const char *hosts_str, int max_hosts, hosts_list_x *list)
+{
+  hosts_arena_x arena;
+  size_t length, size;
+
+  length = strlen (hosts_str);
+  size = hosts_parse_space_x (hosts_str, length);
+  hosts_arena_init_x (&arena, palloc (size), size);
+  return hosts_parse_x (hosts_str, length, max_hosts, 0, &arena, list);
 }
 
 /**
@@ -184,26 +1238,31 @@ int
 manage_count_hosts_max (const char *given_hosts, const char *exclude_hosts,
                         int max_hosts)
 {
-  int count;
-  gvm_hosts_t *hosts;
+  hosts_list_x hosts, exclude;
+  uint64_t count;
 
-  hosts = gvm_hosts_new_with_max (given_hosts, max_hosts);
-  if (hosts == NULL)
-    return -1;
+  if (hosts_parse_alloc_x (given_hosts, max_hosts, &hosts))
+    {
+      pfree (hosts.ranges);
+      return -1;
+    }
 
   if (exclude_hosts)
     {
-      if (gvm_hosts_exclude_with_max (hosts,
-                                      exclude_hosts,
-                                      max_hosts)
-          < 0)
-        return -1;
+      if (hosts_parse_alloc_x (exclude_hosts, max_hosts, &exclude))
+        {
+          pfree (hosts.ranges);
+          pfree (exclude.ranges);
+          return -1;
+        }
+      count = hosts_list_count_x (&hosts, &exclude);
+      pfree (exclude.ranges);
     }
+  else
+    count = hosts_list_count_x (&hosts, NULL);
 
-  count = gvm_hosts_count (hosts);
-  gvm_hosts_free (hosts);
-
-  return count;
+  pfree (hosts.ranges);
+  return count > INT_MAX ? INT_MAX : (int) count;
 }
 
 /**
@@ -222,20 +1281,14 @@ int
 hosts_str_contains (const char* hosts_str, const char* find_host_str,
                     int max_hosts)
 {
-  gvm_hosts_t *hosts, *find_hosts;
-
-  hosts = gvm_hosts_new_with_max (hosts_str, max_hosts);
-  find_hosts = gvm_hosts_new_with_max (find_host_str, 1);
-
-  if (hosts == NULL || find_hosts == NULL || find_hosts->count != 1)
-    {
-      gvm_hosts_free (hosts);
-      gvm_hosts_free (find_hosts);
-      return 0;
-    }
+  hosts_list_x hosts;
+  int ret;
 
-  int ret = gvm_host_in_hosts (find_hosts->hosts[0], NULL, hosts);
-  gvm_hosts_free (hosts);
-  gvm_hosts_free (find_hosts);
+  // A single lookup is faster on the unsorted list than sorting it first.
+  if (hosts_parse_alloc_x (hosts_str, max_hosts, &hosts))
+    ret = 0;
+  else
+    ret = hosts_contains_x (&hosts, find_host_str, strlen (find_host_str));
+  pfree (hosts.ranges);
   return ret;
-}
\ No newline at end of file
+}
@@ -0,0 +1,461 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file hosts_agg.c
+ *
+ * @brief Aggregates of the hosts of many hosts strings
+ *
+ * The state of the aggregates is a list of ranges that is normalized
+ * whenever it fills up, so that it only grows with the number of distinct
+ * ranges and hostnames and not with the number of rows.  The state can be
+ * serialized and combined, so that the aggregates run in parallel workers.
+ */
+
+#include "hosts.h"
+#include "text_arg.h"
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "lib/stringinfo.h"
+#include "libpq/pqformat.h"
+#include "utils/builtins.h"
+
+#include <arpa/inet.h>
+
+/**
+ * @brief Initial number of ranges of a state.
+ */
+#define HOSTS_AGG_INITIAL_SIZE 16
+
+/**
+ * @brief State of the host aggregates.
+ */
+typedef struct
+{
+  hosts_list_x list;   ///< The ranges, hostnames are owned by the state.
+  size_t size;         ///< Allocated number of ranges.
+  size_t sorted;       ///< Number of normalized ranges at the start.
+} hosts_agg_state_x;
+
+/**
+ * @brief Create an empty state.
+ *
+ * @param[in]  context  Memory context of the aggregate.
+ *
+ * @return The state.
+ */
+static hosts_agg_state_x *
+hosts_agg_state_new_x (MemoryContext context)
+{
+  hosts_agg_state_x *state;
+
+  state = MemoryContextAllocZero (context, sizeof (hosts_agg_state_x));
+  state->size = HOSTS_AGG_INITIAL_SIZE;
+  state->list.ranges = MemoryContextAlloc (context,
+                                           state->size
+                                           * sizeof (hosts_range_x));
+  state->list.normalized = 1;
+  return state;
+}
+
+/**
+ * @brief Sort and merge all ranges of a state.
+ *
+ * Normalizing does not change the hosts of the state, so it may also be
+ *  done by the final functions.
+ *
+ * @param[in,out]  state  The state.
+ */
+static void
+hosts_agg_normalize_x (hosts_agg_state_x *state)
+{
+  if (state->sorted == state->list.count)
+    return;
+  state->list.normalized = 0;
+  hosts_list_normalize_x (&state->list);
+  state->sorted = state->list.count;
+}
+
+/**
+ * @brief Add a range to a state.
+ *
+ * Hostnames that are already in the normalized part are skipped, others
+ *  are copied into the context of the aggregate.  A full state is
+ *  normalized first and only grows if that frees less than half of it.
+ *
+ * @param[in,out]  state    The state.
+ * @param[in]      context  Memory context of the aggregate.
+ * @param[in]      range    The range.
+ */
+static void
+hosts_agg_add_x (hosts_agg_state_x *state, MemoryContext context,
+                 const hosts_range_x *range)
+{
+  hosts_range_x *added;
+
+  if (range->type == HOSTS_RANGE_NAME_X && state->sorted)
+    {
+      hosts_list_x sorted;
+
+      sorted.ranges = state->list.ranges;
+      sorted.count = state->sorted;
+      sorted.normalized = 1;
+      if (hosts_list_contains_x (&sorted, range))
+        return;
+    }
+
+  if (state->list.count == state->size)
+    {
+      hosts_agg_normalize_x (state);
+      if (state->list.count > state->size / 2)
+        {
+          state->size *= 2;
+          state->list.ranges = repalloc (state->list.ranges,
+                                         state->size
+                                         * sizeof (hosts_range_x));
+        }
+    }
+
+  added = &state->list.ranges[state->list.count++];
+  *added = *range;
+  if (range->type == HOSTS_RANGE_NAME_X)
+    {
+      char *name;
+
+      name = MemoryContextAlloc (context, range->name_length);
+      memcpy (name, range->name, range->name_length);
+      added->name = name;
+    }
+}
+
+/**
+ * @brief Get the memory context of the aggregate, or fail.
+ *
+ * @param[in]  fcinfo  Function call info of the calling SQL function.
+ *
+ * @return The memory context.
+ */
+static MemoryContext
+hosts_agg_context_x (FunctionCallInfo fcinfo)
+{
+  MemoryContext context;
+
+  if (AggCheckCallContext (fcinfo, &context) == 0)
+    elog (ERROR, "%s: called in non-aggregate context", __func__);
+  return context;
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_hosts_agg_transfn);
+
+/**
+ * @brief Add the hosts of a hosts string to the state of an aggregate.
+ *
+ * Invalid hosts strings are skipped like NULL values.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_hosts_agg_transfn (PG_FUNCTION_ARGS)
+{
+  hosts_agg_state_x *state;
+  MemoryContext context;
+  text_arg_x hosts;
+
+  context = hosts_agg_context_x (fcinfo);
+  if (PG_ARGISNULL (0))
+    state = hosts_agg_state_new_x (context);
+  else
+    state = (hosts_agg_state_x *) PG_GETARG_POINTER (0);
+
+  if (text_arg_get_x (fcinfo, 1, &hosts))
+    {
+      hosts_list_x list;
+      size_t index;
+
+      // The parsed ranges are in the per-row context and freed with it.
+      //  Hostnames are copied by hosts_agg_add_x, so the hosts are parsed
+      //  in place.
+      if (parse_hosts_x (hosts.data, hosts.length, 0, &list) == 0)
+        for (index = 0; index < list.count; index++)
+          hosts_agg_add_x (state, context, &list.ranges[index]);
+    }
+
+  PG_RETURN_POINTER (state);
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_hosts_agg_combinefn);
+
+/**
+ * @brief Combine the states of two partial aggregates.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_hosts_agg_combinefn (PG_FUNCTION_ARGS)
+{
+  hosts_agg_state_x *state, *other;
+  MemoryContext context;
+  size_t index;
+
+  context = hosts_agg_context_x (fcinfo);
+  if (PG_ARGISNULL (1))
+    {
+      if (PG_ARGISNULL (0))
+        PG_RETURN_NULL ();
+      PG_RETURN_POINTER (PG_GETARG_POINTER (0));
+    }
+
+  if (PG_ARGISNULL (0))
+    state = hosts_agg_state_new_x (context);
+  else
+    state = (hosts_agg_state_x *) PG_GETARG_POINTER (0);
+  other = (hosts_agg_state_x *) PG_GETARG_POINTER (1);
+
+  hosts_agg_normalize_x (state);
+  for (index = 0; index < other->list.count; index++)
+    hosts_agg_add_x (state, context, &other->list.ranges[index]);
+
+  PG_RETURN_POINTER (state);
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_hosts_agg_serialfn);
+
+/**
+ * @brief Serialize the state of an aggregate.
+ *
+ * The state is normalized first.  Each range is written as its type,
+ *  followed by the first and last address or the hostname.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_hosts_agg_serialfn (PG_FUNCTION_ARGS)
+{
+  hosts_agg_state_x *state;
+  StringInfoData buffer;
+  size_t index;
+
+  state = (hosts_agg_state_x *) PG_GETARG_POINTER (0);
+  hosts_agg_normalize_x (state);
+
+  pq_begintypsend (&buffer);
+  pq_sendint64 (&buffer, state->list.count);
+  for (index = 0; index < state->list.count; index++)
+    {
+      const hosts_range_x *range;
+
+      range = &state->list.ranges[index];
+      pq_sendbyte (&buffer, range->type);
+      if (range->type == HOSTS_RANGE_NAME_X)
+        {
+          pq_sendint32 (&buffer, range->name_length);
+          pq_sendbytes (&buffer, range->name, range->name_length);
+        }
+      else
+        {
+          pq_sendint64 (&buffer, range->first.high);
+          pq_sendint64 (&buffer, range->first.low);
+          pq_sendint64 (&buffer, range->last.high);
+          pq_sendint64 (&buffer, range->last.low);
+        }
+    }
+
+  PG_RETURN_BYTEA_P (pq_endtypsend (&buffer));
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_hosts_agg_deserialfn);
+
+/**
+ * @brief Deserialize the state of an aggregate.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_hosts_agg_deserialfn (PG_FUNCTION_ARGS)
+{
+  hosts_agg_state_x *state;
+  MemoryContext context;
+  StringInfoData buffer;
+  bytea *serialized;
+  uint64 count, index;
+
+  context = hosts_agg_context_x (fcinfo);
+  serialized = PG_GETARG_BYTEA_PP (0);
+  buffer.data = VARDATA_ANY (serialized);
+  buffer.len = VARSIZE_ANY_EXHDR (serialized);
+  buffer.maxlen = buffer.len;
+  buffer.cursor = 0;
+
+  state = MemoryContextAllocZero (context, sizeof (hosts_agg_state_x));
+  count = pq_getmsgint64 (&buffer);
+  state->size = Max (count, HOSTS_AGG_INITIAL_SIZE);
+  state->list.ranges = MemoryContextAlloc (context,
+                                           state->size
+                                           * sizeof (hosts_range_x));
+  for (index = 0; index < count; index++)
+    {
+      hosts_range_x *range;
+
+      range = &state->list.ranges[index];
+      memset (range, 0, sizeof (hosts_range_x));
+      range->type = pq_getmsgbyte (&buffer);
+      if (range->type == HOSTS_RANGE_NAME_X)
+        {
+          char *name;
+
+          range->name_length = pq_getmsgint (&buffer, 4);
+          name = MemoryContextAlloc (context, range->name_length);
+          memcpy (name, pq_getmsgbytes (&buffer, range->name_length),
+                  range->name_length);
+          range->name = name;
+        }
+      else if (range->type == HOSTS_RANGE_IPV4_X
+               || range->type == HOSTS_RANGE_IPV6_X)
+        {
+          range->first.high = pq_getmsgint64 (&buffer);
+          range->first.low = pq_getmsgint64 (&buffer);
+          range->last.high = pq_getmsgint64 (&buffer);
+          range->last.low = pq_getmsgint64 (&buffer);
+        }
+      else
+        elog (ERROR, "%s: invalid range type %d", __func__, range->type);
+    }
+  pq_getmsgend (&buffer);
+
+  state->list.count = count;
+  state->list.normalized = 1;
+  state->sorted = count;
+
+  PG_RETURN_POINTER (state);
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_hosts_count_distinct_agg_finalfn);
+
+/**
+ * @brief Return the number of distinct hosts of an aggregate.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_hosts_count_distinct_agg_finalfn (PG_FUNCTION_ARGS)
+{
+  hosts_agg_state_x *state;
+  uint64_t count;
+
+  if (PG_ARGISNULL (0))
+    PG_RETURN_INT64 (0);
+
+  state = (hosts_agg_state_x *) PG_GETARG_POINTER (0);
+  hosts_agg_normalize_x (state);
+  count = hosts_list_count_x (&state->list, NULL);
+  PG_RETURN_INT64 (count > PG_INT64_MAX ? PG_INT64_MAX : (int64) count);
+}
+
+/**
+ * @brief Append an address to a string.
+ *
+ * @param[in,out]  string   The string.
+ * @param[in]      type     Type of the address.
+ * @param[in]      address  The address.
+ */
+static void
+hosts_agg_append_address_x (StringInfo string, hosts_range_type_x type,
+                            const hosts_address_x *address)
+{
+  unsigned char bytes[16];
+  char buffer[INET6_ADDRSTRLEN];
+
+  if (type == HOSTS_RANGE_IPV6_X)
+    {
+      hosts_address_to_bytes_x (address, 16, bytes);
+      inet_ntop (AF_INET6, bytes, buffer, sizeof (buffer));
+    }
+  else
+    {
+      hosts_address_to_bytes_x (address, 4, bytes);
+      inet_ntop (AF_INET, bytes, buffer, sizeof (buffer));
+    }
+  appendStringInfoString (string, buffer);
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_hosts_union_agg_finalfn);
+
+/**
+ * @brief Return the distinct hosts of an aggregate as a hosts string.
+ *
+ * The string has the IPv4 ranges first, then the IPv6 ranges and then the
+ *  hostnames, each sorted and without overlaps.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_hosts_union_agg_finalfn (PG_FUNCTION_ARGS)
+{
+  hosts_agg_state_x *state;
+  StringInfoData string;
+  size_t index;
+
+  if (PG_ARGISNULL (0))
+    PG_RETURN_NULL ();
+
+  state = (hosts_agg_state_x *) PG_GETARG_POINTER (0);
+  hosts_agg_normalize_x (state);
+
+  initStringInfo (&string);
+  for (index = 0; index < state->list.count; index++)
+    {
+      const hosts_range_x *range;
+
+      range = &state->list.ranges[index];
+      if (index)
+        appendStringInfoString (&string, ", ");
+      if (range->type == HOSTS_RANGE_NAME_X)
+        {
+          appendBinaryStringInfo (&string, range->name, range->name_length);
+          continue;
+        }
+      hosts_agg_append_address_x (&string, range->type, &range->first);
+      if (range->first.high != range->last.high
+          || range->first.low != range->last.low)
+        {
+          appendStringInfoChar (&string, '-');
+          hosts_agg_append_address_x (&string, range->type, &range->last);
+        }
+    }
+
+  PG_RETURN_TEXT_P (cstring_to_text_with_len (string.data, string.len));
+}
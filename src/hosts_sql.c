@@ -0,0 +1,923 @@
+/* Copyright (C) 2020 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file hosts_sql.c
+ *
+ * @brief This file defines functions that are available via the PostgreSQL
+ * @brief extension
+ */
+
+#include "hosts.h"
+#include "host_cache.h"
+#include "probes.h"
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "access/htup_details.h"
+#include "catalog/pg_statistic.h"
+#include "executor/spi.h"
+#include "nodes/supportnodes.h"
+#include "optimizer/optimizer.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/inet.h"
+#include "utils/selfuncs.h"
+#include "stats.h"
+#include "text_arg.h"
+#include "glib.h"
+
+/**
+ * @brief Maximum number of hosts counted during planning.
+ */
+#define PLANNER_MAX_HOSTS 65536
+
+/**
+ * @brief Maximum number of ranges in a hosts string, 0 for no limit.
+ *
+ * Ranges are never expanded, so the work of parsing, sorting and
+ *  searching a hosts string grows with its ranges, not with its hosts.
+ */
+static int host_range_limit = 16777216;
+
+/**
+ * @brief Define the configuration variables of the host functions.
+ */
+void
+hosts_define_gucs_x (void)
+{
+  DefineCustomIntVariable ("pg_gvm.host_range_limit",
+                           "Maximum number of ranges in a hosts string.",
+                           "Every host, range, CIDR block and hostname of a"
+                           " hosts string is a range.  Hosts strings are"
+                           " rejected with an error while they are parsed"
+                           " once they have more ranges.  Counts in the host"
+                           " count cache are returned without a check."
+                           " 0 disables the check.",
+                           &host_range_limit,
+                           16777216, 0, INT_MAX,
+                           PGC_USERSET, 0,
+                           NULL, NULL, NULL);
+}
+
+/**
+ * @brief Parse a hosts string into ranges allocated in the current context.
+ *
+ * The parser stops at max_hosts and at pg_gvm.host_range_limit.
+ *
+ * @param[in]   hosts      The hosts string, need not be terminated.
+ * @param[in]   length     Length of the hosts string.
+ * @param[in]   max_hosts  Maximum number of hosts, 0 or less for no limit.
+ * @param[out]  list       The ranges, hostnames point into the hosts string.
+ *
+ * @return 0 on success, otherwise the error of hosts_parse_x.
+ */
+static int
+parse_hosts_ranges_x (const char *hosts, size_t length, int max_hosts,
+                      hosts_list_x *list)
+{
+  hosts_arena_x arena;
+  size_t size;
+
+  size = hosts_parse_space_x (hosts, length);
+  hosts_arena_init_x (&arena, palloc (size), size);
+  return hosts_parse_x (hosts, length, max_hosts, host_range_limit, &arena,
+                        list);
+}
+
+/**
+ * @brief Parse a hosts string into ranges allocated in the current context.
+ *
+ * Raises an error if the hosts string has more ranges than
+ *  pg_gvm.host_range_limit.  A hosts string over max_hosts is no error.
+ *
+ * @param[in]   hosts      The hosts string, need not be terminated.
+ * @param[in]   length     Length of the hosts string.
+ * @param[in]   max_hosts  Maximum number of hosts, 0 or less for no limit.
+ * @param[out]  list       The ranges, hostnames point into the hosts string.
+ *
+ * @return 0 on success, otherwise the error of hosts_parse_x.
+ */
+int
+parse_hosts_x (const char *hosts, size_t length, int max_hosts,
+               hosts_list_x *list)
+{
+  int ret;
+
+  ret = parse_hosts_ranges_x (hosts, length, max_hosts, list);
+  if (ret == HOSTS_PARSE_TOO_MANY_RANGES_X)
+    ereport (ERROR,
+             (errcode (ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+              errmsg ("hosts string has more than %d ranges",
+                      host_range_limit),
+              errhint ("Split the hosts or raise"
+                       " pg_gvm.host_range_limit.")));
+  return ret;
+}
+
+/**
+ * @brief Count the hosts of a hosts string during planning.
+ *
+ * @param[in]   hosts    The hosts string.
+ * @param[in]   exclude  The excluded hosts, may be NULL.
+ * @param[out]  ranges   Number of ranges of the hosts, may be NULL.
+ *
+ * @return Number of hosts, or -1 if there are more than PLANNER_MAX_HOSTS
+ *         or on error.
+ */
+static int
+planner_count_hosts_x (const char *hosts, const char *exclude, size_t *ranges)
+{
+  hosts_list_x hosts_list, exclude_list;
+  uint64_t count;
+
+  if (hosts_parse_alloc_x (hosts, PLANNER_MAX_HOSTS, &hosts_list))
+    {
+      pfree (hosts_list.ranges);
+      return -1;
+    }
+
+  if (exclude)
+    {
+      if (hosts_parse_alloc_x (exclude, PLANNER_MAX_HOSTS, &exclude_list))
+        {
+          pfree (hosts_list.ranges);
+          pfree (exclude_list.ranges);
+          return -1;
+        }
+      count = hosts_list_count_x (&hosts_list, &exclude_list);
+      pfree (exclude_list.ranges);
+    }
+  else
+    count = hosts_list_count_x (&hosts_list, NULL);
+
+  // Counting sorted and merged the ranges.
+  if (ranges)
+    *ranges = hosts_list.count;
+  pfree (hosts_list.ranges);
+  return (int) count;
+}
+
+/**
+ * @brief State of a call site of the host functions, kept in fn_extra.
+ */
+typedef struct
+{
+  int max_hosts;        ///< Maximum number of hosts from the meta table.
+  char *hosts;          ///< Hosts of the cached ranges, or NULL.
+  char *exclude;        ///< Excluded hosts of the cached ranges, or NULL.
+  int parsed;           ///< Whether the hosts and excluded hosts are valid.
+  hosts_list_x list;    ///< The ranges without the excluded hosts.
+} hosts_call_cache_x;
+
+/**
+ * @brief Read the maximum number of hosts from the meta table.
+ *
+ * @return The maximum number of hosts.
+ */
+static int
+meta_max_hosts_x (void)
+{
+  int ret;
+  int max_hosts = 4095;
+
+  SPI_connect ();
+  ret = SPI_execute ("SELECT coalesce ((SELECT value FROM meta"
+                     "                  WHERE name = 'max_hosts'),"
+                     "                 '4095');", /* Same as MANAGE_MAX_HOSTS. */
+                     true, /* Read only, so it may run in parallel workers. */
+                     1); /* Max 1 row returned. */
+  if (SPI_processed > 0 && ret > 0 && SPI_tuptable != NULL)
+    {
+      char *cell;
+
+      cell = SPI_getvalue (SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 1);
+      elog (DEBUG1, "cell: %s", cell);
+      if (cell)
+        max_hosts = atoi (cell);
+    }
+  elog (DEBUG1, "done");
+  SPI_finish ();
+
+  return max_hosts;
+}
+
+/**
+ * @brief Get the state of the call site of a host function.
+ *
+ * The maximum number of hosts is read from the meta table once per call
+ *  site and then kept in fn_extra, so that it is not queried again for
+ *  every row.
+ *
+ * @param[in]  fcinfo  Function call info of the calling SQL function.
+ *
+ * @return The state.
+ */
+static hosts_call_cache_x *
+get_hosts_cache_x (FunctionCallInfo fcinfo)
+{
+  hosts_call_cache_x *cache;
+
+  if (fcinfo->flinfo->fn_extra)
+    return fcinfo->flinfo->fn_extra;
+
+  cache = MemoryContextAllocZero (fcinfo->flinfo->fn_mcxt,
+                                  sizeof (hosts_call_cache_x));
+  cache->max_hosts = meta_max_hosts_x ();
+  fcinfo->flinfo->fn_extra = cache;
+
+  return cache;
+}
+
+/**
+ * @brief Get the maximum number of hosts.
+ *
+ * @param[in]  fcinfo  Function call info of the calling SQL function.
+ *
+ * @return The maximum number of hosts.
+ */
+static int
+get_max_hosts_x (FunctionCallInfo fcinfo)
+{
+  return get_hosts_cache_x (fcinfo)->max_hosts;
+}
+
+/**
+ * @brief Check whether a string equals a text argument.
+ *
+ * @param[in]  string  The string, may be NULL.
+ * @param[in]  arg     The argument, may be NULL.
+ *
+ * @return 1 if both are NULL or equal, 0 otherwise.
+ */
+static int
+cached_text_equal_x (const char *string, const text_arg_x *arg)
+{
+  if (string == NULL || arg == NULL)
+    return string == NULL && arg == NULL;
+
+  return strlen (string) == arg->length
+         && memcmp (string, arg->data, arg->length) == 0;
+}
+
+/**
+ * @brief Get the hosts without the excluded hosts as a range list.
+ *
+ * The list is kept in fn_extra and reused as long as the call site is
+ *  called with the same hosts and excluded hosts, so that consecutive rows
+ *  of the same target are not parsed again.
+ *
+ * @param[in]  fcinfo       Function call info of the calling SQL function.
+ * @param[in]  hosts_arg    The hosts.
+ * @param[in]  exclude_arg  The excluded hosts, may be NULL.
+ * @param[in]  call         Measurements of the call.
+ *
+ * @return The list, or NULL if the hosts or excluded hosts are invalid.
+ */
+static hosts_list_x *
+cached_hosts_x (FunctionCallInfo fcinfo, const text_arg_x *hosts_arg,
+                const text_arg_x *exclude_arg, stats_call_x *call)
+{
+  hosts_call_cache_x *cache;
+  hosts_list_x hosts_list, exclude_list;
+  hosts_arena_x arena;
+  MemoryContext old_context;
+  char *hosts, *exclude;
+  size_t size;
+  int parsed;
+
+  cache = get_hosts_cache_x (fcinfo);
+  if (cache->hosts
+      && cached_text_equal_x (cache->hosts, hosts_arg)
+      && cached_text_equal_x (cache->exclude, exclude_arg))
+    {
+      call->cache_hits++;
+      return cache->parsed ? &cache->list : NULL;
+    }
+  call->cache_misses++;
+
+  if (cache->hosts)
+    pfree (cache->hosts);
+  if (cache->exclude)
+    pfree (cache->exclude);
+  if (cache->parsed)
+    pfree (cache->list.ranges);
+  cache->hosts = NULL;
+  cache->exclude = NULL;
+  cache->parsed = 0;
+
+  // The ranges point into the hosts string, so both are kept.
+  old_context = MemoryContextSwitchTo (fcinfo->flinfo->fn_mcxt);
+  hosts = text_arg_cstring_x (hosts_arg);
+  exclude = exclude_arg ? text_arg_cstring_x (exclude_arg) : NULL;
+  MemoryContextSwitchTo (old_context);
+
+  PG_GVM_PARSE_START ("hosts_contains", hosts_arg->length);
+  parsed = 0;
+  if (parse_hosts_x (hosts, hosts_arg->length, cache->max_hosts, &hosts_list)
+      == 0
+      && (exclude == NULL
+          || parse_hosts_x (exclude, exclude_arg->length, cache->max_hosts,
+                            &exclude_list) == 0))
+    {
+      size = hosts_subtract_space_x (&hosts_list,
+                                     exclude ? &exclude_list : NULL);
+      hosts_arena_init_x (&arena,
+                          MemoryContextAlloc (fcinfo->flinfo->fn_mcxt, size),
+                          size);
+      parsed = hosts_list_subtract_x (&hosts_list,
+                                      exclude ? &exclude_list : NULL,
+                                      &arena, &cache->list) == 0;
+    }
+  PG_GVM_PARSE_DONE ("hosts_contains", hosts_arg->length,
+                     parsed ? cache->list.hosts : 0);
+  stats_parsed_x (call, hosts_arg->length
+                        + (exclude_arg ? exclude_arg->length : 0));
+
+  // Only remember the hosts once they are parsed without an error.
+  cache->hosts = hosts;
+  cache->exclude = exclude;
+  cache->parsed = parsed;
+
+  return cache->parsed ? &cache->list : NULL;
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_max_hosts);
+
+
+/**
+ * @brief Return number of hosts.
+ *
+ * This is a callback for a SQL function of two arguments.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_max_hosts (PG_FUNCTION_ARGS)
+{
+  if (PG_ARGISNULL (0))
+    PG_RETURN_INT32 (0);
+  else
+    {
+      text_arg_x hosts, exclude;
+      stats_call_x call;
+      int ret, max_hosts;
+
+      // The hosts are hashed and parsed in place, without a copy.
+      text_arg_get_x (fcinfo, 0, &hosts);
+      text_arg_get_x (fcinfo, 1, &exclude);
+
+      max_hosts = get_max_hosts_x (fcinfo);
+      stats_begin_x (&call);
+      // Cached counts were checked against the limit of the session that
+      //  stored them and cost nothing to return, so they are not checked
+      //  again.
+      if (host_cache_lookup_x (hosts.data, hosts.length, exclude.data,
+                               exclude.length, max_hosts, &ret))
+        call.cache_hits++;
+      else
+        {
+          hosts_list_x hosts_list, exclude_list;
+          size_t length;
+          int parsed;
+
+          length = hosts.length + exclude.length;
+          PG_GVM_PARSE_START ("max_hosts", length);
+          parsed = parse_hosts_x (hosts.data, hosts.length, max_hosts,
+                                  &hosts_list) == 0
+                   && parse_hosts_x (exclude.data, exclude.length, max_hosts,
+                                     &exclude_list) == 0;
+          PG_GVM_PARSE_DONE ("max_hosts", length,
+                             parsed ? hosts_list.hosts : 0);
+          stats_parsed_x (&call, length);
+
+          PG_GVM_EVAL_START ("max_hosts");
+          if (parsed)
+            {
+              uint64_t count;
+
+              count = hosts_list_count_x (&hosts_list, &exclude_list);
+              ret = count > INT_MAX ? INT_MAX : (int) count;
+            }
+          else
+            ret = -1;
+          PG_GVM_EVAL_DONE ("max_hosts", ret, 0);
+          host_cache_store_x (hosts.data, hosts.length, exclude.data,
+                              exclude.length, max_hosts, ret);
+          call.cache_misses++;
+        }
+      stats_end_x (&call, STATS_MAX_HOSTS_X);
+      PG_RETURN_INT32 (ret);
+    }
+}
+
+
+/**
+ * @brief Format a 128 bit number in decimal.
+ *
+ * @param[in]   number  The number.
+ * @param[out]  buffer  Buffer of at least 40 bytes for the digits.
+ */
+static void
+format_hosts_count_x (const hosts_address_x *number, char *buffer)
+{
+  uint32_t limbs[4];
+  char digits[40];
+  int length, index;
+
+  limbs[0] = number->high >> 32;
+  limbs[1] = (uint32_t) number->high;
+  limbs[2] = number->low >> 32;
+  limbs[3] = (uint32_t) number->low;
+
+  // Divide by 10 limb by limb, the remainders are the digits backwards.
+  length = 0;
+  do
+    {
+      uint64_t remainder = 0;
+
+      for (index = 0; index < 4; index++)
+        {
+          uint64_t part;
+
+          part = (remainder << 32) | limbs[index];
+          limbs[index] = part / 10;
+          remainder = part % 10;
+        }
+      digits[length++] = '0' + remainder;
+    }
+  while (limbs[0] | limbs[1] | limbs[2] | limbs[3]);
+
+  for (index = 0; index < length; index++)
+    buffer[index] = digits[length - 1 - index];
+  buffer[length] = '\0';
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_hosts_count);
+
+/**
+ * @brief Return the exact number of hosts without the excluded hosts.
+ *
+ * This is a callback for a SQL function of two arguments.  Unlike
+ *  max_hosts the count is not limited by the maximum number of hosts, since
+ *  ranges are counted without expanding them, so that whole IPv6 networks
+ *  can be counted.  Like everywhere else the hosts strings may have at most
+ *  pg_gvm.host_range_limit ranges.
+ *
+ * @return Postgres Datum, NULL if the hosts or excluded hosts are invalid.
+ */
+Datum
+sql_hosts_count (PG_FUNCTION_ARGS)
+{
+  text_arg_x hosts, exclude;
+  hosts_list_x hosts_list, exclude_list;
+  hosts_address_x count;
+  char digits[40];
+  int has_exclude;
+
+  if (text_arg_get_x (fcinfo, 0, &hosts) == 0)
+    PG_RETURN_NULL ();
+  has_exclude = text_arg_get_x (fcinfo, 1, &exclude);
+
+  if (parse_hosts_x (hosts.data, hosts.length, 0, &hosts_list)
+      || (has_exclude
+          && parse_hosts_x (exclude.data, exclude.length, 0, &exclude_list)))
+    PG_RETURN_NULL ();
+
+  hosts_list_count_wide_x (&hosts_list, has_exclude ? &exclude_list : NULL,
+                           &count);
+  format_hosts_count_x (&count, digits);
+  PG_RETURN_DATUM (DirectFunctionCall3 (numeric_in,
+                                        CStringGetDatum (digits),
+                                        ObjectIdGetDatum (InvalidOid),
+                                        Int32GetDatum (-1)));
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_hosts_contains);
+
+/**
+ * @brief Return if argument 1 matches regular expression in argument 2.
+ *
+ * This is a callback for a SQL function of two arguments.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_hosts_contains (PG_FUNCTION_ARGS)
+{
+  if (PG_ARGISNULL (0) || PG_ARGISNULL (1))
+    PG_RETURN_BOOL (0);
+  else
+    {
+      text_arg_x hosts, find_host;
+      hosts_list_x *list;
+      stats_call_x call;
+      int ret;
+
+      text_arg_get_x (fcinfo, 0, &hosts);
+      text_arg_get_x (fcinfo, 1, &find_host);
+
+      // The hosts are sorted once per call site, so that hostnames and
+      //  addresses are found with a binary search.
+      stats_begin_x (&call);
+      list = cached_hosts_x (fcinfo, &hosts, NULL, &call);
+
+      PG_GVM_EVAL_START ("hosts_contains");
+      ret = list && hosts_contains_x (list, find_host.data, find_host.length);
+      PG_GVM_EVAL_DONE ("hosts_contains", ret, 0);
+
+      stats_end_x (&call, STATS_HOSTS_CONTAINS_X);
+      PG_RETURN_BOOL (ret);
+    }
+}
+
+/**
+ * @brief Check whether an inet address is in the hosts without the excluded.
+ *
+ * @param[in]  fcinfo       Function call info of the calling SQL function.
+ * @param[in]  hosts_arg    The hosts.
+ * @param[in]  exclude_arg  The excluded hosts, may be NULL.
+ * @param[in]  host_arg     The address, the netmask is ignored.
+ *
+ * @return 1 if the address is in the hosts and not excluded, 0 otherwise.
+ */
+static int
+hosts_contains_inet_x (FunctionCallInfo fcinfo, const text_arg_x *hosts_arg,
+                       const text_arg_x *exclude_arg, inet *host_arg)
+{
+  hosts_list_x *list;
+  hosts_range_x host;
+  stats_call_x call;
+  int ret;
+
+  stats_begin_x (&call);
+  list = cached_hosts_x (fcinfo, hosts_arg, exclude_arg, &call);
+
+  PG_GVM_EVAL_START ("hosts_contains");
+  hosts_range_from_bytes_x (ip_addr (host_arg),
+                            ip_family (host_arg) == PGSQL_AF_INET6 ? 16 : 4,
+                            &host);
+  ret = list && hosts_list_contains_x (list, &host);
+  PG_GVM_EVAL_DONE ("hosts_contains", ret, 0);
+  stats_end_x (&call, STATS_HOSTS_CONTAINS_X);
+
+  return ret;
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_hosts_contains_inet);
+
+/**
+ * @brief Return whether an inet address is in a hosts string.
+ *
+ * This is a callback for a SQL function of two arguments.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_hosts_contains_inet (PG_FUNCTION_ARGS)
+{
+  text_arg_x hosts;
+
+  if (PG_ARGISNULL (0) || PG_ARGISNULL (1))
+    PG_RETURN_BOOL (0);
+
+  text_arg_get_x (fcinfo, 0, &hosts);
+  PG_RETURN_BOOL (hosts_contains_inet_x (fcinfo, &hosts, NULL,
+                                         PG_GETARG_INET_PP (1)));
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_hosts_contains_exclude);
+
+/**
+ * @brief Return whether an inet address is in the hosts of a target.
+ *
+ * This is a callback for a SQL function of three arguments: the hosts, the
+ *  excluded hosts and the address.  A NULL exclude excludes nothing.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_hosts_contains_exclude (PG_FUNCTION_ARGS)
+{
+  text_arg_x hosts, exclude;
+
+  if (PG_ARGISNULL (0) || PG_ARGISNULL (2))
+    PG_RETURN_BOOL (0);
+
+  text_arg_get_x (fcinfo, 0, &hosts);
+  PG_RETURN_BOOL (hosts_contains_inet_x (fcinfo, &hosts,
+                                         text_arg_get_x (fcinfo, 1, &exclude)
+                                          ? &exclude : NULL,
+                                         PG_GETARG_INET_PP (2)));
+}
+
+/**
+ * @brief Create an inet of a single address.
+ *
+ * @param[in]  type     Type of the address.
+ * @param[in]  address  The address.
+ *
+ * @return Postgres Datum of the inet.
+ */
+static Datum
+hosts_inet_datum_x (hosts_range_type_x type, const hosts_address_x *address)
+{
+  inet *ret;
+
+  ret = palloc0 (sizeof (inet));
+  if (type == HOSTS_RANGE_IPV6_X)
+    {
+      ip_family (ret) = PGSQL_AF_INET6;
+      ip_bits (ret) = 128;
+      hosts_address_to_bytes_x (address, 16, ip_addr (ret));
+    }
+  else
+    {
+      ip_family (ret) = PGSQL_AF_INET;
+      ip_bits (ret) = 32;
+      hosts_address_to_bytes_x (address, 4, ip_addr (ret));
+    }
+  SET_INET_VARSIZE (ret);
+  return InetPGetDatum (ret);
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_hosts_ranges);
+
+/**
+ * @brief Return the address ranges of the hosts without the excluded hosts.
+ *
+ * This is a set returning callback for a SQL function of two arguments.
+ *  The ranges are computed on the first call and then returned one per
+ *  call, merged and in ascending order with the IPv4 ranges first.
+ *  Hostnames have no address and are left out.  Invalid hosts or more hosts
+ *  than the maximum number of hosts give no ranges, like hosts_contains.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_hosts_ranges (PG_FUNCTION_ARGS)
+{
+  FuncCallContext *funcctx;
+  const hosts_list_x *list;
+  const hosts_range_x *range;
+  Datum values[2];
+  bool nulls[2] = { false, false };
+
+  if (SRF_IS_FIRSTCALL ())
+    {
+      hosts_list_x *result, hosts_list, exclude_list;
+      MemoryContext old_context;
+      TupleDesc tupdesc;
+
+      funcctx = SRF_FIRSTCALL_INIT ();
+      old_context = MemoryContextSwitchTo (funcctx->multi_call_memory_ctx);
+
+      if (get_call_result_type (fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        ereport (ERROR,
+                 (errcode (ERRCODE_FEATURE_NOT_SUPPORTED),
+                  errmsg ("function returning record called in context "
+                          "that cannot accept type record")));
+      funcctx->tuple_desc = BlessTupleDesc (tupdesc);
+
+      result = palloc0 (sizeof (hosts_list_x));
+      if (PG_ARGISNULL (0) == 0)
+        {
+          text_arg_x hosts, exclude;
+          int max_hosts, has_exclude;
+
+          // Only the addresses are returned, so the ranges may point into
+          //  the arguments.
+          max_hosts = meta_max_hosts_x ();
+          text_arg_get_x (fcinfo, 0, &hosts);
+          has_exclude = text_arg_get_x (fcinfo, 1, &exclude);
+          if (parse_hosts_x (hosts.data, hosts.length, max_hosts, &hosts_list)
+              == 0
+              && (has_exclude == 0
+                  || parse_hosts_x (exclude.data, exclude.length, max_hosts,
+                                    &exclude_list) == 0))
+            {
+              hosts_arena_x arena;
+              size_t size;
+
+              size = hosts_subtract_space_x (&hosts_list,
+                                             has_exclude
+                                              ? &exclude_list : NULL);
+              hosts_arena_init_x (&arena, palloc (size), size);
+              if (hosts_list_subtract_x (&hosts_list,
+                                         has_exclude ? &exclude_list : NULL,
+                                         &arena, result))
+                result->count = 0;
+            }
+        }
+
+      // The hostnames are sorted after the addresses, so cut them off.
+      while (result->count
+             && result->ranges[result->count - 1].type == HOSTS_RANGE_NAME_X)
+        result->count--;
+
+      funcctx->user_fctx = result;
+      MemoryContextSwitchTo (old_context);
+    }
+
+  funcctx = SRF_PERCALL_SETUP ();
+  list = funcctx->user_fctx;
+  if (funcctx->call_cntr >= list->count)
+    SRF_RETURN_DONE (funcctx);
+
+  range = &list->ranges[funcctx->call_cntr];
+  values[0] = hosts_inet_datum_x (range->type, &range->first);
+  values[1] = hosts_inet_datum_x (range->type, &range->last);
+  SRF_RETURN_NEXT (funcctx,
+                   HeapTupleGetDatum (heap_form_tuple (funcctx->tuple_desc,
+                                                       values, nulls)));
+}
+
+/**
+ * @brief Estimate the selectivity of hosts_contains.
+ *
+ * If the hosts string is constant, the number of hosts it describes is put
+ *  in relation to the number of distinct values of the host argument.  In a
+ *  join every host is assumed to be in one of the distinct hosts strings.
+ *
+ * @param[in]  req  The selectivity request.
+ *
+ * @return The selectivity.
+ */
+static Selectivity
+hosts_contains_selectivity_x (SupportRequestSelectivity *req)
+{
+  VariableStatData vardata;
+  Selectivity selectivity;
+  double n_distinct;
+  bool is_default;
+  char *hosts, *exclude;
+  int count;
+
+  // Either the hosts and the host or the hosts, the excluded hosts and the
+  //  host.
+  if (list_length (req->args) != 2 && list_length (req->args) != 3)
+    return DEFAULT_EQ_SEL;
+
+  if (req->is_join)
+    {
+      examine_variable (req->root, linitial (req->args), 0, &vardata);
+      n_distinct = get_variable_numdistinct (&vardata, &is_default);
+      ReleaseVariableStats (vardata);
+
+      if (is_default)
+        return DEFAULT_EQ_SEL;
+      return 1.0 / n_distinct;
+    }
+
+  hosts = planner_const_text_x (req->root, linitial (req->args));
+  if (hosts == NULL)
+    return DEFAULT_EQ_SEL;
+
+  // Without a constant exclude the hosts are an upper bound.
+  exclude = list_length (req->args) == 3
+            ? planner_const_text_x (req->root, lsecond (req->args)) : NULL;
+  count = planner_count_hosts_x (hosts, exclude, NULL);
+  pfree (hosts);
+  if (exclude)
+    pfree (exclude);
+
+  // Invalid hosts and hosts over the limit contain no host.
+  if (count <= 0)
+    return 0.0;
+
+  examine_variable (req->root, llast (req->args), req->varRelid, &vardata);
+  n_distinct = get_variable_numdistinct (&vardata, &is_default);
+  if (is_default)
+    selectivity = count * DEFAULT_EQ_SEL;
+  else
+    selectivity = count / n_distinct;
+  if (HeapTupleIsValid (vardata.statsTuple))
+    selectivity *= 1.0 - ((Form_pg_statistic)
+                          GETSTRUCT (vardata.statsTuple))->stanullfrac;
+  ReleaseVariableStats (vardata);
+
+  CLAMP_PROBABILITY (selectivity);
+  return selectivity;
+}
+
+/**
+ * @brief Estimate the cost of hosts_contains per call.
+ *
+ * A constant hosts string is parsed, sorted and merged once per call site,
+ *  which is the startup cost.  Every call then compares the hosts argument
+ *  with the cached string and searches the ranges with a binary search.  An
+ *  invalid hosts string fails to parse once and every call only compares
+ *  the string.
+ *
+ * @param[in]  req  The cost request.
+ *
+ * @return 1 if the cost was estimated, 0 if the default cost should be used.
+ */
+static int
+hosts_contains_cost_x (SupportRequestCost *req)
+{
+  List *args;
+  char *hosts;
+  size_t ranges;
+  int count, length, depth;
+
+  if (req->node == NULL || !IsA (req->node, FuncExpr))
+    return 0;
+
+  args = ((FuncExpr *) req->node)->args;
+  if (list_length (args) < 2)
+    return 0;
+
+  hosts = planner_const_text_x (req->root, linitial (args));
+  if (hosts == NULL)
+    return 0;
+
+  length = strlen (hosts);
+  count = planner_count_hosts_x (hosts, NULL, &ranges);
+  pfree (hosts);
+
+  // The string is compared a word at a time, 8 bytes per operator.
+  req->per_tuple = cpu_operator_cost * (10 + length / 8);
+  if (count < 0)
+    {
+      req->startup = cpu_operator_cost * length;
+      return 1;
+    }
+
+  depth = 0;
+  while (((size_t) 1 << depth) < ranges)
+    depth++;
+  req->startup = cpu_operator_cost * (length + ranges * depth);
+  req->per_tuple += cpu_operator_cost * depth;
+  return 1;
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_hosts_contains_support);
+
+/**
+ * @brief Planner support function for hosts_contains.
+ *
+ * Handles selectivity and cost requests of the planner.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_hosts_contains_support (PG_FUNCTION_ARGS)
+{
+  Node *rawreq = (Node *) PG_GETARG_POINTER (0);
+  Node *ret = NULL;
+
+  if (IsA (rawreq, SupportRequestSelectivity))
+    {
+      SupportRequestSelectivity *req = (SupportRequestSelectivity *) rawreq;
+
+      req->selectivity = hosts_contains_selectivity_x (req);
+      ret = (Node *) req;
+    }
+  else if (IsA (rawreq, SupportRequestCost))
+    {
+      SupportRequestCost *req = (SupportRequestCost *) rawreq;
+
+      if (hosts_contains_cost_x (req))
+        ret = (Node *) req;
+    }
+
+  PG_RETURN_POINTER (ret);
+}
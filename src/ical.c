@@ -24,31 +24,35 @@
  */
 
 #include "ical_utils.h"
+#include "probes.h"
 
 #include "postgres.h"
 #include "fmgr.h"
 #include "executor/spi.h"
+#include "utils/guc.h"
+#include "stats.h"
+#include "text_arg.h"
 
 #ifdef PG_MODULE_MAGIC
 PG_MODULE_MAGIC;
 #endif
 
 /**
- * @brief Create a string from a portion of text.
- *
- * @param[in]  text_arg  Text.
- * @param[in]  length    Length to create.
- *
- * @return Freshly allocated string.
+ * @brief Define the configuration variables of the iCalendar functions.
  */
-static char *
-textndup (text *text_arg, int length)
+void
+ical_define_gucs_x (void)
 {
-  char *ret;
-  ret = palloc (length + 1);
-  memcpy (ret, VARDATA (text_arg), length);
-  ret[length] = 0;
-  return ret;
+  DefineCustomIntVariable ("pg_gvm.ical_max_iterations",
+                           "Maximum number of iterations of a recurrence"
+                           " rule.",
+                           "Calculating a time raises an error if the"
+                           " recurrence needs more iterations. 0 disables"
+                           " the limit.",
+                           &icalendar_max_iterations_x,
+                           10000000, 0, INT_MAX,
+                           PGC_USERSET, 0,
+                           NULL, NULL, NULL);
 }
 
 /**
@@ -66,46 +70,51 @@ PG_FUNCTION_INFO_V1 (sql_next_time_ical);
 Datum
 sql_next_time_ical (PG_FUNCTION_ARGS)
 {
+  text_arg_x ical_arg, zone_arg;
   char *ical_string, *zone;
+  icalcomponent *ical_parsed;
+  icalendar_guard_x *guard;
+  stats_call_x call;
   int64 reference_time;
   int periods_offset;
   int32 ret;
 
-  if (PG_NARGS() < 1 || PG_ARGISNULL (0))
-    {
-      PG_RETURN_NULL ();
-    }
-  else
-    {
-      text* ical_string_arg;
-      ical_string_arg = PG_GETARG_TEXT_P (0);
-      ical_string = textndup (ical_string_arg,
-                              VARSIZE (ical_string_arg) - VARHDRSZ);
-    }
+  // libical parses terminated strings only, so the calendar is copied once.
+  if (text_arg_get_x (fcinfo, 0, &ical_arg) == 0)
+    PG_RETURN_NULL ();
+  ical_string = text_arg_cstring_x (&ical_arg);
 
   if (PG_NARGS() < 2 || PG_ARGISNULL (1))
     reference_time = 0;
   else
     reference_time = PG_GETARG_INT64 (1);
-    
-  if (PG_NARGS() < 3 || PG_ARGISNULL (2))
-    zone = NULL;
+
+  if (text_arg_get_x (fcinfo, 2, &zone_arg))
+    zone = text_arg_cstring_x (&zone_arg);
   else
-    {
-      text* timezone_arg;
-      timezone_arg = PG_GETARG_TEXT_P (2);
-      zone = textndup (timezone_arg, VARSIZE (timezone_arg) - VARHDRSZ);
-    }
+    zone = NULL;
 
   if (PG_NARGS() < 4)
     periods_offset = 0;
   else
     periods_offset = PG_GETARG_INT32 (3);
 
-  ret = icalendar_next_time_from_string_x (ical_string, reference_time, zone,
-                                           periods_offset);
-  if (ical_string)
-    pfree (ical_string);
+  stats_begin_x (&call);
+  icalendar_reset_iterations_x ();
+  PG_GVM_PARSE_START ("next_time_ical", ical_arg.length);
+  ical_parsed = icalcomponent_new_from_string (ical_string);
+  guard = icalendar_guard_component_x (ical_parsed);
+  PG_GVM_PARSE_DONE ("next_time_ical", ical_arg.length, 0);
+  stats_parsed_x (&call, ical_arg.length);
+  PG_GVM_EVAL_START ("next_time_ical");
+  ret = icalendar_next_time_from_vcalendar_x (ical_parsed, reference_time,
+                                              zone, periods_offset);
+  icalendar_guard_release_x (guard);
+  call.iterations = icalendar_iterations_x ();
+  PG_GVM_EVAL_DONE ("next_time_ical", ret, call.iterations);
+  stats_end_x (&call, STATS_NEXT_TIME_ICAL_X);
+
+  pfree (ical_string);
   if (zone)
     pfree (zone);
   PG_RETURN_INT32 (ret);
@@ -0,0 +1,573 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ical_gist.c
+ *
+ * @brief Index support for schedules with an occurrence in a time window
+ *
+ * Defines the ical_span type, the text && tstzrange operator and the GiST
+ * operator class gist_ical_ops.  The keys of the index are the spans of the
+ * occurrences of the schedules, so that schedules outside of a window are
+ * pruned without evaluating their recurrence.  Matches are rechecked with
+ * the exact operator unless the span and period of the schedule guarantee an
+ * occurrence in the window.
+ */
+
+#include "ical_utils.h"
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "access/gist.h"
+#include "access/stratnum.h"
+#include "datatype/timestamp.h"
+#include "utils/builtins.h"
+#include "utils/rangetypes.h"
+#include "utils/timestamp.h"
+
+/**
+ * @brief Strategy number of the && operator.
+ */
+#define ICAL_OVERLAP_STRATEGY RTOverlapStrategyNumber
+
+/**
+ * @brief Earliest time of a window, for windows without lower bound.
+ */
+#define ICAL_WINDOW_MIN ((int64) PG_INT32_MIN)
+
+/**
+ * @brief Microseconds between the Unix and the PostgreSQL epoch.
+ */
+#define ICAL_EPOCH_DIFF_USECS \
+  ((int64) (POSTGRES_EPOCH_JDATE - UNIX_EPOCH_JDATE) * SECS_PER_DAY \
+   * USECS_PER_SEC)
+
+/**
+ * @brief Set a span that matches no window.
+ *
+ * @param[out]  span  The span.
+ */
+static void
+ical_span_set_empty_x (icalendar_span_x *span)
+{
+  span->start = PG_INT64_MAX;
+  span->end = PG_INT64_MIN;
+  span->period = 0;
+}
+
+/**
+ * @brief Get the span of the occurrences of an iCalendar text.
+ *
+ * @param[in]   ical_arg  The iCalendar text.
+ * @param[out]  span      The span, empty if there are no occurrences.
+ *
+ * @return 0 on success, -1 if there are no occurrences.
+ */
+static int
+ical_span_from_text_x (text *ical_arg, icalendar_span_x *span)
+{
+  icalcomponent *ical_parsed;
+  icalendar_guard_x *guard;
+  char *ical_string;
+  int ret;
+
+  ical_string = text_to_cstring (ical_arg);
+  ical_parsed = icalcomponent_new_from_string (ical_string);
+  guard = icalendar_guard_component_x (ical_parsed);
+  ret = icalendar_span_from_vcalendar_x (ical_parsed, NULL, span);
+  icalendar_guard_release_x (guard);
+  pfree (ical_string);
+
+  if (ret)
+    ical_span_set_empty_x (span);
+  return ret;
+}
+
+/**
+ * @brief Convert a timestamp to seconds since the Unix epoch.
+ *
+ * @param[in]  timestamp  The timestamp.
+ * @param[in]  round_up   Whether to round fractions of seconds up.
+ *
+ * @return The seconds.
+ */
+static int64
+ical_timestamp_seconds_x (TimestampTz timestamp, bool round_up)
+{
+  int64 usecs, seconds;
+
+  usecs = timestamp + ICAL_EPOCH_DIFF_USECS;
+  seconds = usecs / USECS_PER_SEC;
+  // Division truncates towards zero, round towards minus infinity first.
+  if (usecs % USECS_PER_SEC < 0)
+    seconds--;
+  if (round_up && (usecs - seconds * USECS_PER_SEC) > 0)
+    seconds++;
+  return seconds;
+}
+
+/**
+ * @brief Get the window of a tstzrange in whole seconds.
+ *
+ * Occurrences are at whole seconds, so the window is narrowed to the whole
+ *  seconds in the range, both ends inclusive.
+ *
+ * @param[in]   range  The range.
+ * @param[out]  from   Start of the window.
+ * @param[out]  to     End of the window.
+ *
+ * @return Whether the window is not empty.
+ */
+static bool
+ical_range_window_x (RangeType *range, int64 *from, int64 *to)
+{
+  TypeCacheEntry *typcache;
+  RangeBound lower, upper;
+  bool empty;
+
+  typcache = lookup_type_cache (RangeTypeGetOid (range),
+                                TYPECACHE_RANGE_INFO);
+  range_deserialize (typcache, range, &lower, &upper, &empty);
+  if (empty)
+    return false;
+
+  if (lower.infinite || TIMESTAMP_IS_NOBEGIN (DatumGetTimestampTz (lower.val)))
+    *from = ICAL_WINDOW_MIN;
+  else if (TIMESTAMP_IS_NOEND (DatumGetTimestampTz (lower.val)))
+    return false;
+  else
+    {
+      TimestampTz timestamp = DatumGetTimestampTz (lower.val);
+
+      *from = ical_timestamp_seconds_x (timestamp, true);
+      if (lower.inclusive == false
+          && (timestamp + ICAL_EPOCH_DIFF_USECS) % USECS_PER_SEC == 0)
+        (*from)++;
+    }
+
+  if (upper.infinite || TIMESTAMP_IS_NOEND (DatumGetTimestampTz (upper.val)))
+    *to = PG_INT64_MAX;
+  else if (TIMESTAMP_IS_NOBEGIN (DatumGetTimestampTz (upper.val)))
+    return false;
+  else
+    {
+      TimestampTz timestamp = DatumGetTimestampTz (upper.val);
+
+      *to = ical_timestamp_seconds_x (timestamp, false);
+      if (upper.inclusive == false
+          && (timestamp + ICAL_EPOCH_DIFF_USECS) % USECS_PER_SEC == 0)
+        (*to)--;
+    }
+
+  if (*from < ICAL_WINDOW_MIN)
+    *from = ICAL_WINDOW_MIN;
+  return *from <= *to;
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_ical_span_in);
+
+/**
+ * @brief Read an ical_span from its text form "(start,end,period)".
+ *
+ * The end may be "infinity" for spans without end.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_ical_span_in (PG_FUNCTION_ARGS)
+{
+  char *input = PG_GETARG_CSTRING (0);
+  icalendar_span_x *span;
+  char *position, *end;
+
+  span = palloc (sizeof (icalendar_span_x));
+  position = input;
+  if (*position++ != '(')
+    goto invalid;
+
+  span->start = strtoll (position, &end, 10);
+  if (end == position || *end != ',')
+    goto invalid;
+  position = end + 1;
+
+  if (strncmp (position, "infinity", strlen ("infinity")) == 0)
+    {
+      span->end = ICALENDAR_SPAN_OPEN_X;
+      end = position + strlen ("infinity");
+    }
+  else
+    span->end = strtoll (position, &end, 10);
+  if (end == position || *end != ',')
+    goto invalid;
+  position = end + 1;
+
+  span->period = strtoll (position, &end, 10);
+  if (end == position || strcmp (end, ")") != 0 || span->period < 0)
+    goto invalid;
+
+  PG_RETURN_POINTER (span);
+
+ invalid:
+  ereport (ERROR,
+           (errcode (ERRCODE_INVALID_TEXT_REPRESENTATION),
+            errmsg ("invalid input syntax for type ical_span: \"%s\"",
+                    input)));
+  PG_RETURN_NULL ();
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_ical_span_out);
+
+/**
+ * @brief Write an ical_span in its text form.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_ical_span_out (PG_FUNCTION_ARGS)
+{
+  icalendar_span_x *span = (icalendar_span_x *) PG_GETARG_POINTER (0);
+
+  if (span->end == ICALENDAR_SPAN_OPEN_X)
+    PG_RETURN_CSTRING (psprintf ("(" INT64_FORMAT ",infinity," INT64_FORMAT
+                                 ")",
+                                 span->start, span->period));
+  PG_RETURN_CSTRING (psprintf ("(" INT64_FORMAT "," INT64_FORMAT ","
+                               INT64_FORMAT ")",
+                               span->start, span->end, span->period));
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_ical_span);
+
+/**
+ * @brief Get the span of the occurrences of a schedule.
+ *
+ * This is a callback for a SQL function of one argument.
+ *
+ * @return Postgres Datum, NULL if the schedule has no occurrences.
+ */
+Datum
+sql_ical_span (PG_FUNCTION_ARGS)
+{
+  icalendar_span_x *span;
+
+  span = palloc (sizeof (icalendar_span_x));
+  if (ical_span_from_text_x (PG_GETARG_TEXT_PP (0), span))
+    PG_RETURN_NULL ();
+  PG_RETURN_POINTER (span);
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_ical_occurs_in);
+
+/**
+ * @brief Return whether a schedule has an occurrence in a tstzrange.
+ *
+ * This is a callback for a SQL function of two arguments.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_ical_occurs_in (PG_FUNCTION_ARGS)
+{
+  icalcomponent *ical_parsed;
+  icalendar_guard_x *guard;
+  char *ical_string;
+  int64 from, to;
+  int ret;
+
+  if (ical_range_window_x (PG_GETARG_RANGE_P (1), &from, &to) == false)
+    PG_RETURN_BOOL (false);
+
+  ical_string = text_to_cstring (PG_GETARG_TEXT_PP (0));
+  ical_parsed = icalcomponent_new_from_string (ical_string);
+  guard = icalendar_guard_component_x (ical_parsed);
+  ret = icalendar_occurs_between_x (ical_parsed, NULL, from, to);
+  icalendar_guard_release_x (guard);
+  pfree (ical_string);
+
+  PG_RETURN_BOOL (ret);
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_gist_ical_compress);
+
+/**
+ * @brief Compress a schedule to the span of its occurrences.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_gist_ical_compress (PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER (0);
+  GISTENTRY *ret;
+  icalendar_span_x *span;
+
+  if (entry->leafkey == false)
+    PG_RETURN_POINTER (entry);
+
+  span = palloc (sizeof (icalendar_span_x));
+  ical_span_from_text_x (DatumGetTextPP (entry->key), span);
+
+  ret = palloc (sizeof (GISTENTRY));
+  gistentryinit (*ret, PointerGetDatum (span), entry->rel, entry->page,
+                 entry->offset, false);
+  PG_RETURN_POINTER (ret);
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_gist_ical_consistent);
+
+/**
+ * @brief Check whether a span may have an occurrence in a window.
+ *
+ * Leaf matches need no recheck if the window lies within the span and is at
+ *  least as long as the longest time between two occurrences.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_gist_ical_consistent (PG_FUNCTION_ARGS)
+{
+  GISTENTRY *entry = (GISTENTRY *) PG_GETARG_POINTER (0);
+  RangeType *query = PG_GETARG_RANGE_P (1);
+  StrategyNumber strategy = (StrategyNumber) PG_GETARG_UINT16 (2);
+  bool *recheck = (bool *) PG_GETARG_POINTER (4);
+  icalendar_span_x *span;
+  int64 from, to;
+
+  if (strategy != ICAL_OVERLAP_STRATEGY)
+    elog (ERROR, "%s: unrecognized strategy number: %d", __func__, strategy);
+
+  *recheck = true;
+  if (ical_range_window_x (query, &from, &to) == false)
+    PG_RETURN_BOOL (false);
+
+  span = (icalendar_span_x *) DatumGetPointer (entry->key);
+  if (span->start > to || span->end < from)
+    PG_RETURN_BOOL (false);
+
+  if (GIST_LEAF (entry) && span->period > 0
+      && from >= span->start && to <= span->end
+      && to - from >= span->period)
+    *recheck = false;
+
+  PG_RETURN_BOOL (true);
+}
+
+/**
+ * @brief Extend a span to include another one.
+ *
+ * @param[in,out]  span   The span to extend.
+ * @param[in]      other  The span to include.
+ */
+static void
+ical_span_extend_x (icalendar_span_x *span, const icalendar_span_x *other)
+{
+  if (other->start < span->start)
+    span->start = other->start;
+  if (other->end > span->end)
+    span->end = other->end;
+  span->period = 0;
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_gist_ical_union);
+
+/**
+ * @brief Get the span covering a set of spans.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_gist_ical_union (PG_FUNCTION_ARGS)
+{
+  GistEntryVector *entryvec = (GistEntryVector *) PG_GETARG_POINTER (0);
+  int *size = (int *) PG_GETARG_POINTER (1);
+  icalendar_span_x *ret;
+  int index;
+
+  ret = palloc (sizeof (icalendar_span_x));
+  ical_span_set_empty_x (ret);
+  for (index = 0; index < entryvec->n; index++)
+    ical_span_extend_x (ret, (icalendar_span_x *)
+                             DatumGetPointer (entryvec->vector[index].key));
+
+  *size = sizeof (icalendar_span_x);
+  PG_RETURN_POINTER (ret);
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_gist_ical_penalty);
+
+/**
+ * @brief Get the cost of inserting a span into a subtree.
+ *
+ * The cost is the time by which the span of the subtree grows.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_gist_ical_penalty (PG_FUNCTION_ARGS)
+{
+  GISTENTRY *original = (GISTENTRY *) PG_GETARG_POINTER (0);
+  GISTENTRY *new = (GISTENTRY *) PG_GETARG_POINTER (1);
+  float *penalty = (float *) PG_GETARG_POINTER (2);
+  icalendar_span_x *original_span, *new_span;
+  double growth;
+
+  original_span = (icalendar_span_x *) DatumGetPointer (original->key);
+  new_span = (icalendar_span_x *) DatumGetPointer (new->key);
+
+  growth = 0;
+  if (new_span->start < original_span->start)
+    growth += (double) original_span->start - (double) new_span->start;
+  if (new_span->end > original_span->end)
+    growth += (double) new_span->end - (double) original_span->end;
+
+  *penalty = (float) growth;
+  PG_RETURN_POINTER (penalty);
+}
+
+/**
+ * @brief An entry to split, with its offset.
+ */
+typedef struct
+{
+  OffsetNumber offset;        ///< Offset of the entry.
+  icalendar_span_x *span;     ///< Span of the entry.
+} ical_split_entry_x;
+
+/**
+ * @brief Compare two entries by start and end of their spans for qsort.
+ */
+static int
+ical_split_entry_compare_x (const void *one, const void *two)
+{
+  const icalendar_span_x *a = ((const ical_split_entry_x *) one)->span;
+  const icalendar_span_x *b = ((const ical_split_entry_x *) two)->span;
+
+  if (a->start != b->start)
+    return a->start < b->start ? -1 : 1;
+  if (a->end != b->end)
+    return a->end < b->end ? -1 : 1;
+  return 0;
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_gist_ical_picksplit);
+
+/**
+ * @brief Split a page, putting the earlier half of the spans to the left.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_gist_ical_picksplit (PG_FUNCTION_ARGS)
+{
+  GistEntryVector *entryvec = (GistEntryVector *) PG_GETARG_POINTER (0);
+  GIST_SPLITVEC *splitvec = (GIST_SPLITVEC *) PG_GETARG_POINTER (1);
+  ical_split_entry_x *entries;
+  icalendar_span_x *left, *right;
+  OffsetNumber offset, maxoff;
+  int count, index;
+
+  maxoff = entryvec->n - 1;
+  count = maxoff - FirstOffsetNumber + 1;
+
+  entries = palloc (sizeof (ical_split_entry_x) * count);
+  for (offset = FirstOffsetNumber; offset <= maxoff; offset++)
+    {
+      entries[offset - FirstOffsetNumber].offset = offset;
+      entries[offset - FirstOffsetNumber].span = (icalendar_span_x *)
+        DatumGetPointer (entryvec->vector[offset].key);
+    }
+  qsort (entries, count, sizeof (ical_split_entry_x),
+         ical_split_entry_compare_x);
+
+  splitvec->spl_left = palloc (sizeof (OffsetNumber) * (maxoff + 1));
+  splitvec->spl_right = palloc (sizeof (OffsetNumber) * (maxoff + 1));
+  splitvec->spl_nleft = 0;
+  splitvec->spl_nright = 0;
+
+  left = palloc (sizeof (icalendar_span_x));
+  right = palloc (sizeof (icalendar_span_x));
+  ical_span_set_empty_x (left);
+  ical_span_set_empty_x (right);
+
+  for (index = 0; index < count; index++)
+    if (index < count / 2)
+      {
+        splitvec->spl_left[splitvec->spl_nleft++] = entries[index].offset;
+        ical_span_extend_x (left, entries[index].span);
+      }
+    else
+      {
+        splitvec->spl_right[splitvec->spl_nright++] = entries[index].offset;
+        ical_span_extend_x (right, entries[index].span);
+      }
+
+  splitvec->spl_ldatum = PointerGetDatum (left);
+  splitvec->spl_rdatum = PointerGetDatum (right);
+
+  pfree (entries);
+  PG_RETURN_POINTER (splitvec);
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_gist_ical_same);
+
+/**
+ * @brief Return whether two spans are equal.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_gist_ical_same (PG_FUNCTION_ARGS)
+{
+  icalendar_span_x *a = (icalendar_span_x *) PG_GETARG_POINTER (0);
+  icalendar_span_x *b = (icalendar_span_x *) PG_GETARG_POINTER (1);
+  bool *result = (bool *) PG_GETARG_POINTER (2);
+
+  *result = a->start == b->start && a->end == b->end
+            && a->period == b->period;
+  PG_RETURN_POINTER (result);
+}
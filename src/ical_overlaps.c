@@ -0,0 +1,404 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file ical_overlaps.c
+ *
+ * @brief Conflicts and concurrency of schedules in a time window
+ *
+ * Every schedule is turned into a stream of occurrences that is only
+ * generated as far as needed.  The streams are merged in a heap ordered by
+ * their next occurrence and swept once over the window, keeping the running
+ * occurrences in a second heap ordered by their end.
+ */
+
+#include "ical_utils.h"
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "catalog/pg_type.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/hsearch.h"
+
+/**
+ * @brief An entry of a heap, the smallest key first.
+ */
+typedef struct
+{
+  int64 key;    ///< Time the entry is ordered by.
+  int index;    ///< Index of the schedule.
+} overlaps_heap_entry_x;
+
+/**
+ * @brief A binary min-heap that grows as needed.
+ */
+typedef struct
+{
+  overlaps_heap_entry_x *entries;   ///< The entries.
+  int len;                          ///< Number of entries.
+  int cap;                          ///< Allocated number of entries.
+} overlaps_heap_x;
+
+/**
+ * @brief A pair of conflicting schedules, the smaller index first.
+ */
+typedef struct
+{
+  int32 first;    ///< Index of the first schedule.
+  int32 second;   ///< Index of the second schedule.
+} overlaps_pair_x;
+
+/**
+ * @brief Initialise a heap.
+ *
+ * @param[out]  heap  The heap.
+ * @param[in]   cap   Initial number of entries.
+ */
+static void
+overlaps_heap_init_x (overlaps_heap_x *heap, int cap)
+{
+  heap->cap = cap > 0 ? cap : 1;
+  heap->len = 0;
+  heap->entries = palloc (sizeof (overlaps_heap_entry_x) * heap->cap);
+}
+
+/**
+ * @brief Add an entry to a heap.
+ *
+ * @param[in]  heap   The heap.
+ * @param[in]  key    Key of the entry.
+ * @param[in]  index  Index of the schedule.
+ */
+static void
+overlaps_heap_push_x (overlaps_heap_x *heap, int64 key, int index)
+{
+  int position;
+
+  if (heap->len == heap->cap)
+    {
+      heap->cap *= 2;
+      heap->entries = repalloc (heap->entries,
+                                sizeof (overlaps_heap_entry_x) * heap->cap);
+    }
+
+  position = heap->len++;
+  while (position > 0)
+    {
+      int parent = (position - 1) / 2;
+
+      if (heap->entries[parent].key <= key)
+        break;
+      heap->entries[position] = heap->entries[parent];
+      position = parent;
+    }
+  heap->entries[position].key = key;
+  heap->entries[position].index = index;
+}
+
+/**
+ * @brief Remove the smallest entry of a heap.
+ *
+ * @param[in]  heap  The heap, must not be empty.
+ *
+ * @return The removed entry.
+ */
+static overlaps_heap_entry_x
+overlaps_heap_pop_x (overlaps_heap_x *heap)
+{
+  overlaps_heap_entry_x first, last;
+  int position;
+
+  first = heap->entries[0];
+  last = heap->entries[--heap->len];
+  position = 0;
+  for (;;)
+    {
+      int child = 2 * position + 1;
+
+      if (child >= heap->len)
+        break;
+      if (child + 1 < heap->len
+          && heap->entries[child + 1].key < heap->entries[child].key)
+        child++;
+      if (last.key <= heap->entries[child].key)
+        break;
+      heap->entries[position] = heap->entries[child];
+      position = child;
+    }
+  if (heap->len)
+    heap->entries[position] = last;
+  return first;
+}
+
+/**
+ * @brief Compare two pairs for sorting.
+ *
+ * @param[in]  one  First pair.
+ * @param[in]  two  Second pair.
+ *
+ * @return Less than, equal to or greater than 0 like strcmp.
+ */
+static int
+overlaps_pair_compare_x (const void *one, const void *two)
+{
+  const overlaps_pair_x *first = one, *second = two;
+
+  if (first->first != second->first)
+    return first->first < second->first ? -1 : 1;
+  if (first->second != second->second)
+    return first->second < second->second ? -1 : 1;
+  return 0;
+}
+
+/**
+ * @brief Build an int4 array from the pairs.
+ *
+ * @param[in]  pairs   The pairs.
+ * @param[in]  count   Number of pairs.
+ * @param[in]  second  Whether to take the second or the first schedules.
+ *
+ * @return The array.
+ */
+static ArrayType *
+overlaps_pairs_array_x (overlaps_pair_x *pairs, int count, int second)
+{
+  Datum *values;
+  int index;
+
+  values = palloc (sizeof (Datum) * (count + 1));
+  for (index = 0; index < count; index++)
+    values[index] = Int32GetDatum (second ? pairs[index].second
+                                          : pairs[index].first);
+  return construct_array (values, count, INT4OID, sizeof (int32), true, 'i');
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_ical_overlaps);
+
+/**
+ * @brief Find the schedules running at the same time within a window.
+ *
+ * Each occurrence of a schedule runs from its start for the duration of the
+ *  schedule, a duration of 0 or NULL counts as one second.  Schedules are
+ *  evaluated in UTC unless DTSTART has a timezone.  Occurrences that started
+ *  before the window but still run in it are included.
+ *
+ * This is a callback for a SQL function of four arguments: the iCalendar
+ *  texts, their durations in seconds and the start and end of the window.
+ *  It returns the pairs of conflicting schedules as 1-based indexes into the
+ *  arrays, the largest number of schedules running at the same time and the
+ *  first time it was reached.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_ical_overlaps (PG_FUNCTION_ARGS)
+{
+  ArrayType *icals_arg, *durations_arg;
+  Datum *icals, *durations, values[4];
+  bool *icals_nulls, *durations_nulls, nulls[4];
+  icalendar_occurrences_x **streams;
+  icalendar_guard_x **guards;
+  int64 *active_end, *lengths, from, to, peak_time;
+  bool *active;
+  overlaps_heap_x starts, ends;
+  overlaps_pair_x *pairs, *pair;
+  HASHCTL hash_ctl;
+  HASH_SEQ_STATUS status;
+  HTAB *pair_table;
+  TupleDesc tupdesc;
+  int count, durations_count, index, running, peak, pairs_count;
+
+  icals_arg = PG_GETARG_ARRAYTYPE_P (0);
+  durations_arg = PG_GETARG_ARRAYTYPE_P (1);
+  from = PG_GETARG_INT64 (2);
+  to = PG_GETARG_INT64 (3);
+
+  if (get_call_result_type (fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+    elog (ERROR, "%s: return type must be a row type", __func__);
+  tupdesc = BlessTupleDesc (tupdesc);
+
+  if (ARR_NDIM (icals_arg) > 1 || ARR_NDIM (durations_arg) > 1)
+    ereport (ERROR,
+             (errcode (ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+              errmsg ("schedules and durations must be one-dimensional")));
+
+  deconstruct_array (icals_arg, TEXTOID, -1, false, 'i',
+                     &icals, &icals_nulls, &count);
+  deconstruct_array (durations_arg, INT4OID, sizeof (int32), true, 'i',
+                     &durations, &durations_nulls, &durations_count);
+  if (count != durations_count)
+    ereport (ERROR,
+             (errcode (ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+              errmsg ("there are %d schedules but %d durations",
+                      count, durations_count)));
+
+  streams = palloc0 (sizeof (icalendar_occurrences_x *) * (count + 1));
+  guards = palloc0 (sizeof (icalendar_guard_x *) * (count + 1));
+  lengths = palloc (sizeof (int64) * (count + 1));
+  active_end = palloc0 (sizeof (int64) * (count + 1));
+  active = palloc0 (sizeof (bool) * (count + 1));
+  overlaps_heap_init_x (&starts, count);
+  overlaps_heap_init_x (&ends, count);
+
+  // Open a stream per schedule, starting with the occurrences still running
+  //  at the start of the window.
+  for (index = 0; index < count; index++)
+    {
+      icalcomponent *ical_parsed;
+      char *ical_string;
+      time_t time;
+
+      lengths[index] = durations_nulls[index]
+                       ? 1 : DatumGetInt32 (durations[index]);
+      if (lengths[index] < 0)
+        ereport (ERROR,
+                 (errcode (ERRCODE_INVALID_PARAMETER_VALUE),
+                  errmsg ("duration of schedule %d is negative", index + 1)));
+      if (lengths[index] == 0)
+        lengths[index] = 1;
+
+      if (icals_nulls[index])
+        continue;
+
+      ical_string = text_to_cstring (DatumGetTextPP (icals[index]));
+      ical_parsed = icalcomponent_new_from_string (ical_string);
+      pfree (ical_string);
+      // Invalid schedules have no occurrences, like NULL ones.
+      if (ical_parsed == NULL)
+        continue;
+      guards[index] = icalendar_guard_component_x (ical_parsed);
+      streams[index] = icalendar_occurrences_new_x (ical_parsed, "UTC",
+                                                    from - lengths[index] + 1);
+      if (streams[index]
+          && icalendar_occurrences_next_x (streams[index], &time)
+          && time < to)
+        overlaps_heap_push_x (&starts, time, index);
+    }
+
+  memset (&hash_ctl, 0, sizeof (hash_ctl));
+  hash_ctl.keysize = sizeof (overlaps_pair_x);
+  hash_ctl.entrysize = sizeof (overlaps_pair_x);
+  hash_ctl.hcxt = CurrentMemoryContext;
+  pair_table = hash_create ("pg-gvm schedule conflicts", 256, &hash_ctl,
+                            HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
+  // Sweep over the starts of the occurrences in time order.
+  running = 0;
+  peak = 0;
+  peak_time = 0;
+  while (starts.len)
+    {
+      overlaps_heap_entry_x start;
+      int64 time, end;
+      time_t next;
+
+      CHECK_FOR_INTERRUPTS ();
+
+      start = overlaps_heap_pop_x (&starts);
+      index = start.index;
+      end = start.key + lengths[index];
+      time = start.key < from ? from : start.key;
+
+      // End the occurrences that are over, skipping outdated entries.
+      while (ends.len && ends.entries[0].key <= time)
+        {
+          overlaps_heap_entry_x ended;
+
+          ended = overlaps_heap_pop_x (&ends);
+          if (active[ended.index] && active_end[ended.index] == ended.key)
+            {
+              active[ended.index] = false;
+              running--;
+            }
+        }
+
+      if (active[index])
+        {
+          // The schedule overlaps itself, which makes it run longer.
+          if (end > active_end[index])
+            {
+              active_end[index] = end;
+              overlaps_heap_push_x (&ends, end, index);
+            }
+        }
+      else
+        {
+          int position;
+
+          for (position = 0; position < ends.len; position++)
+            {
+              overlaps_heap_entry_x *other;
+              overlaps_pair_x pair;
+
+              other = &ends.entries[position];
+              if (active[other->index] == false
+                  || active_end[other->index] != other->key)
+                continue;
+              pair.first = Min (index, other->index) + 1;
+              pair.second = Max (index, other->index) + 1;
+              hash_search (pair_table, &pair, HASH_ENTER, NULL);
+            }
+
+          active[index] = true;
+          active_end[index] = end;
+          overlaps_heap_push_x (&ends, end, index);
+          running++;
+          if (running > peak)
+            {
+              peak = running;
+              peak_time = time;
+            }
+        }
+
+      if (icalendar_occurrences_next_x (streams[index], &next) && next < to)
+        overlaps_heap_push_x (&starts, next, index);
+    }
+
+  for (index = 0; index < count; index++)
+    {
+      icalendar_occurrences_free_x (streams[index]);
+      if (guards[index])
+        icalendar_guard_release_x (guards[index]);
+    }
+
+  pairs_count = hash_get_num_entries (pair_table);
+  pairs = palloc (sizeof (overlaps_pair_x) * (pairs_count + 1));
+  hash_seq_init (&status, pair_table);
+  index = 0;
+  while ((pair = hash_seq_search (&status)) != NULL)
+    pairs[index++] = *pair;
+  qsort (pairs, pairs_count, sizeof (overlaps_pair_x),
+         overlaps_pair_compare_x);
+  hash_destroy (pair_table);
+
+  memset (nulls, 0, sizeof (nulls));
+  values[0] = PointerGetDatum (overlaps_pairs_array_x (pairs, pairs_count, 0));
+  values[1] = PointerGetDatum (overlaps_pairs_array_x (pairs, pairs_count, 1));
+  values[2] = Int32GetDatum (peak);
+  values[3] = Int64GetDatum (peak_time);
+  nulls[3] = peak == 0;
+
+  PG_RETURN_DATUM (HeapTupleGetDatum (heap_form_tuple (tupdesc, values,
+                                                       nulls)));
+}
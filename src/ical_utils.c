@@ -27,6 +27,142 @@
 #include "ical_utils.h"
 #include "array.h"
 #include "postgres.h"
+#include "miscadmin.h"
+
+/**
+ * @brief Maximum number of iterations of a single recurrence, 0 for no limit.
+ */
+int icalendar_max_iterations_x = 10000000;
+
+/**
+ * @brief Number of recurrence iterations since the last reset.
+ */
+static long recurrence_iterations = 0;
+
+/**
+ * @brief Frees a libical object when the memory context it was created in
+ *        is reset, so that it is not leaked if an error is raised.
+ */
+struct icalendar_guard_x
+{
+  MemoryContextCallback callback;   ///< Callback of the memory context.
+  icalcomponent *component;         ///< Component to free, or NULL.
+  icalrecur_iterator *iterator;     ///< Iterator to free, or NULL.
+};
+
+/**
+ * @brief Free the object of a guard.
+ *
+ * @param[in]  arg  The guard.
+ */
+static void
+icalendar_guard_free_x (void *arg)
+{
+  icalendar_guard_x *guard = arg;
+
+  if (guard->component)
+    icalcomponent_free (guard->component);
+  if (guard->iterator)
+    icalrecur_iterator_free (guard->iterator);
+  guard->component = NULL;
+  guard->iterator = NULL;
+}
+
+/**
+ * @brief Create a guard in the current memory context.
+ *
+ * @param[in]  component  Component to free, or NULL.
+ * @param[in]  iterator   Iterator to free, or NULL.
+ *
+ * @return The guard.
+ */
+static icalendar_guard_x *
+icalendar_guard_new_x (icalcomponent *component, icalrecur_iterator *iterator)
+{
+  icalendar_guard_x *guard;
+
+  guard = palloc0 (sizeof (icalendar_guard_x));
+  guard->component = component;
+  guard->iterator = iterator;
+  guard->callback.func = icalendar_guard_free_x;
+  guard->callback.arg = guard;
+  MemoryContextRegisterResetCallback (CurrentMemoryContext, &guard->callback);
+  return guard;
+}
+
+/**
+ * @brief Guard a component, freeing it if an error is raised.
+ *
+ * @param[in]  component  The component, may be NULL.
+ *
+ * @return The guard, to be released with icalendar_guard_release_x.
+ */
+icalendar_guard_x *
+icalendar_guard_component_x (icalcomponent *component)
+{
+  return icalendar_guard_new_x (component, NULL);
+}
+
+/**
+ * @brief Free the object of a guard now.
+ *
+ * @param[in]  guard  The guard.
+ */
+void
+icalendar_guard_release_x (icalendar_guard_x *guard)
+{
+  icalendar_guard_free_x (guard);
+}
+
+/**
+ * @brief Reset the number of recurrence iterations.
+ */
+void
+icalendar_reset_iterations_x (void)
+{
+  recurrence_iterations = 0;
+}
+
+/**
+ * @brief Get the number of recurrence iterations since the last reset.
+ *
+ * @return The number of iterations.
+ */
+long
+icalendar_iterations_x (void)
+{
+  return recurrence_iterations;
+}
+
+/**
+ * @brief Get the next time of a recurrence, counting the iteration.
+ *
+ * Checks for interrupts and raises an error if the recurrence needs more
+ *  than icalendar_max_iterations_x iterations.
+ *
+ * @param[in]      recur_iter  The recurrence iterator.
+ * @param[in,out]  iterations  Iterations of the recurrence so far.
+ *
+ * @return The next time, or a null time if there are no more.
+ */
+static icaltimetype
+icalendar_recurrence_next_x (icalrecur_iterator *recur_iter, int *iterations)
+{
+  CHECK_FOR_INTERRUPTS ();
+
+  if (icalendar_max_iterations_x > 0
+      && *iterations >= icalendar_max_iterations_x)
+    ereport (ERROR,
+             (errcode (ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+              errmsg ("iCalendar recurrence needs more than %d iterations",
+                      icalendar_max_iterations_x),
+              errhint ("Move DTSTART closer to the reference time or raise"
+                       " pg_gvm.ical_max_iterations.")));
+
+  (*iterations)++;
+  recurrence_iterations++;
+  return icalrecur_iterator_next (recur_iter);
+}
 
 /**
  * @brief Collect the times of EXDATE or RDATE properties from an VEVENT.
@@ -199,12 +335,16 @@ icalendar_next_time_from_recurrence_x (struct icalrecurrencetype recurrence,
                                        int periods_offset)
 {
   icalrecur_iterator *recur_iter;
+  icalendar_guard_x *guard;
   icaltimetype recur_time, prev_time, next_time;
   time_t rdates_time;
+  int iterations;
 
   // Start iterating over rule-based times
   recur_iter = icalrecur_iterator_new (recurrence, dtstart);
-  recur_time = icalrecur_iterator_next (recur_iter);
+  guard = icalendar_guard_new_x (NULL, recur_iter);
+  iterations = 0;
+  recur_time = icalendar_recurrence_next_x (recur_iter, &iterations);
 
   if (icaltime_is_null_time (recur_time))
     {
@@ -229,7 +369,8 @@ icalendar_next_time_from_recurrence_x (struct icalrecurrencetype recurrence,
       while (icaltime_is_null_time (recur_time) == 0
              && icalendar_time_matches_array_x (recur_time, exdates))
         {
-          recur_time = icalrecur_iterator_next (recur_iter);
+          recur_time = icalendar_recurrence_next_x (recur_iter,
+                                                    &iterations);
         }
 
       // Set the first recur_time as either the previous or next time.
@@ -250,20 +391,24 @@ icalendar_next_time_from_recurrence_x (struct icalrecurrencetype recurrence,
           if (icalendar_time_matches_array_x (recur_time, exdates) == 0)
             prev_time = recur_time;
 
-          recur_time = icalrecur_iterator_next (recur_iter);
+          recur_time = icalendar_recurrence_next_x (recur_iter,
+                                                    &iterations);
         }
 
       // Skip further ahead if last recurrence time is in EXDATEs
       while (icaltime_is_null_time (recur_time) == 0
              && icalendar_time_matches_array_x (recur_time, exdates))
         {
-          recur_time = icalrecur_iterator_next (recur_iter);
+          recur_time = icalendar_recurrence_next_x (recur_iter,
+                                                    &iterations);
         }
 
       // Select last recur_time as the next_time
       next_time = recur_time;
     }
 
+  icalendar_guard_release_x (guard);
+
   // Get time from RDATEs
   rdates_time = icalendar_next_time_from_rdates_x (rdates, reference_time, tz,
                                                  periods_offset);
@@ -317,6 +462,56 @@ icalendar_timezone_from_string_x (const char *tzid)
 }
 
 
+/**
+ * @brief Get the first VEVENT of a VCALENDAR with its start and timezone.
+ *
+ * @param[in]   vcalendar        The VCALENDAR component.
+ * @param[in]   default_tzid     Timezone id to use if none is set in the iCal.
+ * @param[out]  dtstart_with_tz  Start time of the VEVENT, with timezone.
+ * @param[out]  tz               Timezone of the VEVENT.
+ *
+ * @return The VEVENT, or NULL if there is no VEVENT with a start time.
+ */
+static icalcomponent *
+icalendar_vevent_x (icalcomponent *vcalendar, const char *default_tzid,
+                    icaltimetype *dtstart_with_tz, icaltimezone **tz)
+{
+  icalcomponent *vevent;
+  icaltimetype dtstart;
+
+  // Component must be a VCALENDAR
+  if (vcalendar == NULL
+      || icalcomponent_isa (vcalendar) != ICAL_VCALENDAR_COMPONENT)
+    return NULL;
+
+  // Process only the first VEVENT
+  // Others should be removed by icalendar_from_string
+  vevent = icalcomponent_get_first_component (vcalendar,
+                                              ICAL_VEVENT_COMPONENT);
+  if (vevent == NULL)
+    return NULL;
+
+  // Get start time and timezone
+  dtstart = icalcomponent_get_dtstart (vevent);
+  if (icaltime_is_null_time (dtstart))
+    return NULL;
+
+  *tz = (icaltimezone*) icaltime_get_timezone (dtstart);
+  if (*tz == NULL)
+    {
+      *tz = icalendar_timezone_from_string_x (default_tzid);
+      if (*tz == NULL)
+        *tz = icaltimezone_get_utc_timezone ();
+    }
+
+  *dtstart_with_tz = dtstart;
+  // Set timezone in case the original DTSTART did not have any set.
+  icaltime_set_timezone (dtstart_with_tz, *tz);
+
+  return vevent;
+}
+
+
 /**
  * @brief  Get the next or previous due time from a VCALENDAR component.
  * The VCALENDAR must have simplified with icalendar_from_string for this to
@@ -336,9 +531,8 @@ icalendar_next_time_from_vcalendar_x (icalcomponent *vcalendar,
                                       const char *default_tzid,
                                       int periods_offset)
 {
-  time_t now;
   icalcomponent *vevent;
-  icaltimetype dtstart, dtstart_with_tz, ical_reference_time;
+  icaltimetype dtstart_with_tz, ical_reference_time;
   icaltimezone *tz;
   icalproperty *rrule_prop;
   struct icalrecurrencetype recurrence;
@@ -349,35 +543,11 @@ icalendar_next_time_from_vcalendar_x (icalcomponent *vcalendar,
   if (periods_offset < -1 || periods_offset > 0)
     return 0;
 
-  // Component must be a VCALENDAR
-  if (vcalendar == NULL
-      || icalcomponent_isa (vcalendar) != ICAL_VCALENDAR_COMPONENT)
-    return 0;
-
-  // Process only the first VEVENT
-  // Others should be removed by icalendar_from_string
-  vevent = icalcomponent_get_first_component (vcalendar,
-                                              ICAL_VEVENT_COMPONENT);
+  vevent = icalendar_vevent_x (vcalendar, default_tzid, &dtstart_with_tz,
+                               &tz);
   if (vevent == NULL)
     return 0;
 
-  // Get start time and timezone
-  dtstart = icalcomponent_get_dtstart (vevent);
-  if (icaltime_is_null_time (dtstart))
-    return 0;
-
-  tz = (icaltimezone*) icaltime_get_timezone (dtstart);
-  if (tz == NULL)
-    {
-      tz = icalendar_timezone_from_string_x (default_tzid);
-      if (tz == NULL)
-        tz = icaltimezone_get_utc_timezone ();
-    }
-
-  dtstart_with_tz = dtstart;
-  // Set timezone in case the original DTSTART did not have any set.
-  icaltime_set_timezone (&dtstart_with_tz, tz);
-
   // Get current time
   ical_reference_time = icaltime_from_timet_with_zone (reference_time, 0, tz);
   // Set timezone explicitly because icaltime_current_time_with_zone doesn't.
@@ -413,6 +583,395 @@ icalendar_next_time_from_vcalendar_x (icalcomponent *vcalendar,
 }
 
 
+/**
+ * @brief Largest COUNT of a recurrence that is iterated to find its end.
+ */
+#define ICALENDAR_SPAN_MAX_COUNT 100000
+
+/**
+ * @brief Get the longest time between two occurrences of a recurrence rule.
+ *
+ * Only simple rules are handled, for rules with BY parts the time cannot be
+ *  known without iterating.
+ *
+ * @param[in]  recurrence  The recurrence rule.
+ * @param[in]  dtstart     The start time of the recurrence.
+ *
+ * @return The time in seconds, or 0 if not known.
+ */
+static int64_t
+icalendar_rule_period_x (struct icalrecurrencetype *recurrence,
+                         icaltimetype dtstart)
+{
+  const char *rule;
+  int64_t base;
+
+  rule = icalrecurrencetype_as_string (recurrence);
+  if (rule == NULL || strstr (rule, "BY"))
+    return 0;
+
+  switch (recurrence->freq)
+    {
+      case ICAL_SECONDLY_RECURRENCE:
+        base = 1;
+        break;
+      case ICAL_MINUTELY_RECURRENCE:
+        base = 60;
+        break;
+      case ICAL_HOURLY_RECURRENCE:
+        base = 3600;
+        break;
+      case ICAL_DAILY_RECURRENCE:
+        base = 86400;
+        break;
+      case ICAL_WEEKLY_RECURRENCE:
+        base = 7 * 86400;
+        break;
+      case ICAL_MONTHLY_RECURRENCE:
+        // Months without the day are skipped.
+        if (dtstart.day > 28)
+          return 0;
+        base = 31 * 86400;
+        break;
+      case ICAL_YEARLY_RECURRENCE:
+        if (dtstart.month == 2 && dtstart.day == 29)
+          return 0;
+        base = 366 * 86400;
+        break;
+      default:
+        return 0;
+    }
+
+  // Allow for daylight saving time changes.
+  return base * (recurrence->interval > 0 ? recurrence->interval : 1) + 3600;
+}
+
+/**
+ * @brief Get the span of the occurrences of a VCALENDAR component.
+ *
+ * The span reaches from the first to the last occurrence, or is open-ended
+ *  if the recurrence has no end.  The period is the longest time between two
+ *  consecutive occurrences, so that any window within the span at least as
+ *  long as the period has an occurrence.  It is 0 if not known, for example
+ *  if there are EXDATEs or RDATEs.
+ *
+ * @param[in]   vcalendar     The VCALENDAR component.
+ * @param[in]   default_tzid  Timezone id to use if none is set in the iCal.
+ * @param[out]  span          The span.
+ *
+ * @return 0 on success, -1 if the component has no occurrences.
+ */
+int
+icalendar_span_from_vcalendar_x (icalcomponent *vcalendar,
+                                 const char *default_tzid,
+                                 icalendar_span_x *span)
+{
+  icalcomponent *vevent;
+  icaltimetype dtstart_with_tz;
+  icaltimezone *tz;
+  icalproperty *rrule_prop;
+  array_x *exdates, *rdates;
+  int index;
+
+  vevent = icalendar_vevent_x (vcalendar, default_tzid, &dtstart_with_tz,
+                               &tz);
+  if (vevent == NULL)
+    return -1;
+
+  span->start = icaltime_as_timet_with_zone (dtstart_with_tz, tz);
+  span->end = span->start;
+  span->period = 0;
+
+  exdates = icalendar_times_from_vevent_x (vevent, ICAL_EXDATE_PROPERTY);
+  rdates = icalendar_times_from_vevent_x (vevent, ICAL_RDATE_PROPERTY);
+
+  for (index = 0; index < rdates->len; index++)
+    {
+      time_t rdate;
+
+      rdate = icaltime_as_timet_with_zone (*(icaltimetype*) rdates->data[index],
+                                           tz);
+      if (rdate < span->start)
+        span->start = rdate;
+      if (rdate > span->end)
+        span->end = rdate;
+    }
+
+  rrule_prop = icalcomponent_get_first_property (vevent, ICAL_RRULE_PROPERTY);
+  if (rrule_prop)
+    {
+      struct icalrecurrencetype recurrence;
+
+      recurrence = icalproperty_get_rrule (rrule_prop);
+      if (icaltime_is_null_time (recurrence.until) == 0)
+        {
+          time_t until;
+
+          until = icaltime_as_timet_with_zone (recurrence.until,
+                                               recurrence.until.zone
+                                                ? recurrence.until.zone
+                                                : tz);
+          if (until > span->end)
+            span->end = until;
+        }
+      else if (recurrence.count > 0
+               && recurrence.count <= ICALENDAR_SPAN_MAX_COUNT)
+        {
+          icalrecur_iterator *recur_iter;
+          icalendar_guard_x *guard;
+          icaltimetype recur_time, last_time;
+          int iterations;
+
+          recur_iter = icalrecur_iterator_new (recurrence, dtstart_with_tz);
+          guard = icalendar_guard_new_x (NULL, recur_iter);
+          iterations = 0;
+          last_time = icaltime_null_time ();
+          recur_time = icalendar_recurrence_next_x (recur_iter, &iterations);
+          while (icaltime_is_null_time (recur_time) == 0)
+            {
+              last_time = recur_time;
+              recur_time = icalendar_recurrence_next_x (recur_iter,
+                                                        &iterations);
+            }
+          icalendar_guard_release_x (guard);
+
+          if (icaltime_is_null_time (last_time) == 0
+              && icaltime_as_timet_with_zone (last_time, tz) > span->end)
+            span->end = icaltime_as_timet_with_zone (last_time, tz);
+        }
+      else
+        span->end = ICALENDAR_SPAN_OPEN_X;
+
+      if (exdates->len == 0 && rdates->len == 0)
+        span->period = icalendar_rule_period_x (&recurrence, dtstart_with_tz);
+    }
+
+  free_array_x (exdates);
+  free_array_x (rdates);
+  return 0;
+}
+
+/**
+ * @brief Check whether a VCALENDAR component has an occurrence in a window.
+ *
+ * @param[in]  vcalendar     The VCALENDAR component.
+ * @param[in]  default_tzid  Timezone id to use if none is set in the iCal.
+ * @param[in]  from          Start of the window, inclusive.
+ * @param[in]  to            End of the window, inclusive.
+ *
+ * @return 1 if there is an occurrence in the window, 0 otherwise.
+ */
+int
+icalendar_occurs_between_x (icalcomponent *vcalendar,
+                            const char *default_tzid,
+                            time_t from, time_t to)
+{
+  time_t next_time;
+
+  if (from > to)
+    return 0;
+
+  // The next time is strictly after the reference time.
+  next_time = icalendar_next_time_from_vcalendar_x (vcalendar, from - 1,
+                                                    default_tzid, 0);
+  return next_time != 0 && next_time >= from && next_time <= to;
+}
+
+
+/**
+ * @brief Occurrences of a VCALENDAR component, generated one at a time.
+ */
+struct icalendar_occurrences_x
+{
+  icalendar_guard_x *guard;       ///< Guard of the recurrence iterator.
+  icalrecur_iterator *iterator;   ///< Iterator of the RRULE, or NULL.
+  icaltimezone *tz;               ///< Timezone of the VEVENT.
+  array_x *exdates;               ///< Times to skip.
+  time_t *rdates;                 ///< Sorted times of the RDATEs.
+  int rdates_len;                 ///< Number of RDATEs.
+  int rdate_index;                ///< Next RDATE.
+  time_t rule_next;               ///< Next time of the rule.
+  int rule_done;                  ///< Whether the rule has no more times.
+  int iterations;                 ///< Iterations of the rule so far.
+  time_t last;                    ///< Last returned time.
+  int started;                    ///< Whether a time was returned.
+};
+
+/**
+ * @brief Compare two times for sorting.
+ *
+ * @param[in]  one  First time.
+ * @param[in]  two  Second time.
+ *
+ * @return Less than, equal to or greater than 0 like strcmp.
+ */
+static int
+icalendar_time_compare_x (const void *one, const void *two)
+{
+  time_t first = *(const time_t *) one;
+  time_t second = *(const time_t *) two;
+
+  return first < second ? -1 : (first > second ? 1 : 0);
+}
+
+/**
+ * @brief Advance the rule of an occurrence stream, skipping EXDATEs.
+ *
+ * @param[in]  occurrences  The occurrence stream.
+ */
+static void
+icalendar_occurrences_advance_rule_x (icalendar_occurrences_x *occurrences)
+{
+  icaltimetype recur_time;
+
+  if (occurrences->iterator == NULL)
+    {
+      occurrences->rule_done = 1;
+      return;
+    }
+
+  do
+    recur_time = icalendar_recurrence_next_x (occurrences->iterator,
+                                              &occurrences->iterations);
+  while (icaltime_is_null_time (recur_time) == 0
+         && icalendar_time_matches_array_x (recur_time,
+                                            occurrences->exdates));
+
+  if (icaltime_is_null_time (recur_time))
+    occurrences->rule_done = 1;
+  else
+    occurrences->rule_next = icaltime_as_timet_with_zone (recur_time,
+                                                          occurrences->tz);
+}
+
+/**
+ * @brief Start generating the occurrences of a VCALENDAR component.
+ *
+ * The occurrences of the RRULE, without the EXDATEs, and the RDATEs are
+ *  merged in ascending order, or DTSTART is the only occurrence if there is
+ *  no RRULE.  Occurrences are only generated when they are asked for, so
+ *  that a stream can be consumed up to the end of a window.
+ *
+ * @param[in]  vcalendar     The VCALENDAR component, must outlive the stream.
+ * @param[in]  default_tzid  Timezone id to use if none is set in the iCal.
+ * @param[in]  from          Earliest occurrence to generate.
+ *
+ * @return The occurrence stream, or NULL if there are no occurrences.
+ */
+icalendar_occurrences_x *
+icalendar_occurrences_new_x (icalcomponent *vcalendar,
+                             const char *default_tzid, time_t from)
+{
+  icalendar_occurrences_x *occurrences;
+  icalcomponent *vevent;
+  icaltimetype dtstart_with_tz;
+  icaltimezone *tz;
+  icalproperty *rrule_prop;
+  array_x *rdates;
+  int index;
+
+  vevent = icalendar_vevent_x (vcalendar, default_tzid, &dtstart_with_tz,
+                               &tz);
+  if (vevent == NULL)
+    return NULL;
+
+  occurrences = palloc0 (sizeof (icalendar_occurrences_x));
+  occurrences->tz = tz;
+  occurrences->exdates = icalendar_times_from_vevent_x (vevent,
+                                                        ICAL_EXDATE_PROPERTY);
+
+  rdates = icalendar_times_from_vevent_x (vevent, ICAL_RDATE_PROPERTY);
+  occurrences->rdates = palloc (sizeof (time_t) * (rdates->len + 1));
+  occurrences->rdates_len = rdates->len;
+  for (index = 0; index < rdates->len; index++)
+    occurrences->rdates[index]
+      = icaltime_as_timet_with_zone (*(icaltimetype*) rdates->data[index], tz);
+  qsort (occurrences->rdates, occurrences->rdates_len, sizeof (time_t),
+         icalendar_time_compare_x);
+  free_array_x (rdates);
+
+  rrule_prop = icalcomponent_get_first_property (vevent, ICAL_RRULE_PROPERTY);
+  if (rrule_prop)
+    {
+      occurrences->iterator
+        = icalrecur_iterator_new (icalproperty_get_rrule (rrule_prop),
+                                  dtstart_with_tz);
+      occurrences->guard = icalendar_guard_new_x (NULL, occurrences->iterator);
+      icalendar_occurrences_advance_rule_x (occurrences);
+    }
+  else
+    occurrences->rule_next = icaltime_as_timet_with_zone (dtstart_with_tz,
+                                                          tz);
+
+  // Skip the occurrences before the start.
+  while (occurrences->rule_done == 0 && occurrences->rule_next < from)
+    icalendar_occurrences_advance_rule_x (occurrences);
+  while (occurrences->rdate_index < occurrences->rdates_len
+         && occurrences->rdates[occurrences->rdate_index] < from)
+    occurrences->rdate_index++;
+
+  return occurrences;
+}
+
+/**
+ * @brief Get the next occurrence of an occurrence stream.
+ *
+ * @param[in]   occurrences  The occurrence stream.
+ * @param[out]  time         The next occurrence.
+ *
+ * @return 1 if there is another occurrence, 0 at the end.
+ */
+int
+icalendar_occurrences_next_x (icalendar_occurrences_x *occurrences,
+                              time_t *time)
+{
+  for (;;)
+    {
+      int has_rdate;
+
+      has_rdate = occurrences->rdate_index < occurrences->rdates_len;
+      if (occurrences->rule_done && has_rdate == 0)
+        return 0;
+
+      if (occurrences->rule_done == 0
+          && (has_rdate == 0
+              || occurrences->rule_next
+                 <= occurrences->rdates[occurrences->rdate_index]))
+        {
+          *time = occurrences->rule_next;
+          icalendar_occurrences_advance_rule_x (occurrences);
+        }
+      else
+        *time = occurrences->rdates[occurrences->rdate_index++];
+
+      // RDATEs may repeat times of the rule.
+      if (occurrences->started == 0 || *time != occurrences->last)
+        {
+          occurrences->started = 1;
+          occurrences->last = *time;
+          return 1;
+        }
+    }
+}
+
+/**
+ * @brief Free an occurrence stream.
+ *
+ * @param[in]  occurrences  The occurrence stream, may be NULL.
+ */
+void
+icalendar_occurrences_free_x (icalendar_occurrences_x *occurrences)
+{
+  if (occurrences == NULL)
+    return;
+  if (occurrences->guard)
+    icalendar_guard_release_x (occurrences->guard);
+  free_array_x (occurrences->exdates);
+  pfree (occurrences->rdates);
+  pfree (occurrences);
+}
+
+
 /**
  * @brief  Get the next or previous due time from a VCALENDAR string.
  * The string must be a VCALENDAR simplified with icalendar_from_string for
@@ -434,12 +993,14 @@ icalendar_next_time_from_string_x (const char *ical_string,
 {
   time_t next_time;
   icalcomponent *ical_parsed;
+  icalendar_guard_x *guard;
 
   ical_parsed = icalcomponent_new_from_string (ical_string);
+  guard = icalendar_guard_component_x (ical_parsed);
   next_time = icalendar_next_time_from_vcalendar_x (ical_parsed,
                                                     reference_time,
                                                     default_tzid,
                                                     periods_offset);
-  icalcomponent_free (ical_parsed);
+  icalendar_guard_release_x (guard);
   return next_time;
 }
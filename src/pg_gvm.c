@@ -0,0 +1,115 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pg_gvm.c
+ *
+ * @brief Initialization of the PostgreSQL extension
+ *
+ * Defines the configuration variables and, if the library is loaded via
+ * shared_preload_libraries, sets up the shared memory and registers the
+ * background workers.
+ */
+
+#include "host_cache.h"
+#include "hosts.h"
+#include "ical_utils.h"
+#include "schedule_worker.h"
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+#include "storage/ipc.h"
+#include "utils/guc.h"
+#include "stats.h"
+
+void
+_PG_init (void);
+
+#if PG_VERSION_NUM >= 150000
+/**
+ * @brief Previous shared memory request hook.
+ */
+static shmem_request_hook_type prev_shmem_request_hook = NULL;
+#endif
+
+/**
+ * @brief Previous shared memory startup hook.
+ */
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+/**
+ * @brief Request the shared memory of all modules.
+ */
+static void
+pg_gvm_shmem_request (void)
+{
+#if PG_VERSION_NUM >= 150000
+  if (prev_shmem_request_hook)
+    prev_shmem_request_hook ();
+#endif
+
+  host_cache_shmem_request_x ();
+  stats_shmem_request_x ();
+}
+
+/**
+ * @brief Initialize the shared memory of all modules.
+ */
+static void
+pg_gvm_shmem_startup (void)
+{
+  if (prev_shmem_startup_hook)
+    prev_shmem_startup_hook ();
+
+  host_cache_shmem_startup_x ();
+  stats_shmem_startup_x ();
+}
+
+/**
+ * @brief Initialize the library when it is loaded.
+ */
+void
+_PG_init (void)
+{
+  host_cache_define_gucs_x ();
+  hosts_define_gucs_x ();
+  ical_define_gucs_x ();
+  schedule_worker_define_gucs_x ();
+  stats_define_gucs_x ();
+
+#if PG_VERSION_NUM >= 150000
+  MarkGUCPrefixReserved ("pg_gvm");
+#else
+  EmitWarningsOnPlaceholders ("pg_gvm");
+#endif
+
+  if (!process_shared_preload_libraries_in_progress)
+    return;
+
+#if PG_VERSION_NUM >= 150000
+  prev_shmem_request_hook = shmem_request_hook;
+  shmem_request_hook = pg_gvm_shmem_request;
+#else
+  pg_gvm_shmem_request ();
+#endif
+  prev_shmem_startup_hook = shmem_startup_hook;
+  shmem_startup_hook = pg_gvm_shmem_startup;
+
+  schedule_worker_register_x ();
+}
@@ -27,25 +27,19 @@
 
 #include "postgres.h"
 #include "fmgr.h"
+#include "access/htup_details.h"
+#include "catalog/pg_statistic.h"
+#include "catalog/pg_type.h"
 #include "executor/spi.h"
-
-/**
- * @brief Create a string from a portion of text.
- *
- * @param[in]  text_arg  Text.
- * @param[in]  length    Length to create.
- *
- * @return Freshly allocated string.
- */
-static char *
-textndup (text *text_arg, int length)
-{
-  char *ret;
-  ret = palloc (length + 1);
-  memcpy (ret, VARDATA (text_arg), length);
-  ret[length] = 0;
-  return ret;
-}
+#include "nodes/nodeFuncs.h"
+#include "nodes/supportnodes.h"
+#include "optimizer/optimizer.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
+#include "utils/selfuncs.h"
+#include "probes.h"
+#include "stats.h"
+#include "text_arg.h"
 
 /**
  * @brief Define function for Postgres.
@@ -67,23 +61,270 @@ sql_regexp (PG_FUNCTION_ARGS)
     PG_RETURN_BOOL (0);
   else
     {
-      text *string_arg, *regexp_arg;
-      char *string, *regexp;
+      text_arg_x string, regexp_arg;
+      char *regexp;
+      stats_call_x call;
+      GRegex *regex;
       int ret;
 
-      regexp_arg = PG_GETARG_TEXT_P(1);
-      regexp = textndup (regexp_arg, VARSIZE (regexp_arg) - VARHDRSZ);
+      // Only the pattern needs a terminated copy, the string is matched in
+      //  place.
+      text_arg_get_x (fcinfo, 1, &regexp_arg);
+      regexp = text_arg_cstring_x (&regexp_arg);
+      text_arg_get_x (fcinfo, 0, &string);
 
-      string_arg = PG_GETARG_TEXT_P(0);
-      string = textndup (string_arg, VARSIZE (string_arg) - VARHDRSZ);
+      stats_begin_x (&call);
+      PG_GVM_PARSE_START ("regexp", regexp_arg.length);
+      regex = g_regex_new ((gchar *) regexp, 0, 0, NULL);
+      PG_GVM_PARSE_DONE ("regexp", regexp_arg.length, 0);
+      stats_parsed_x (&call, regexp_arg.length);
 
-      if (g_regex_match_simple ((gchar *) regexp, (gchar *) string, 0, 0))
+      PG_GVM_EVAL_START ("regexp");
+      if (regex
+          && g_regex_match_full (regex, (const gchar *) string.data,
+                                 string.length, 0, 0, NULL, NULL))
         ret = 1;
       else
         ret = 0;
+      PG_GVM_EVAL_DONE ("regexp", ret, 0);
+
+      if (regex)
+        g_regex_unref (regex);
+      stats_end_x (&call, STATS_REGEXP_X);
 
-      pfree (string);
       pfree (regexp);
       PG_RETURN_BOOL (ret);
     }
 }
+
+/**
+ * @brief Estimate how expensive a regular expression is to compile and match.
+ *
+ * Every character counts, quantifiers, alternations, groups and character
+ *  classes count more and backreferences, which may need backtracking, count
+ *  most.
+ *
+ * @param[in]  pattern  The regular expression.
+ *
+ * @return The complexity of the regular expression.
+ */
+static double
+regexp_complexity_x (const char *pattern)
+{
+  double complexity = 0;
+  const char *point;
+
+  for (point = pattern; *point; point++)
+    switch (*point)
+      {
+        case '\\':
+          if (point[1] >= '1' && point[1] <= '9')
+            complexity += 50;
+          else
+            complexity += 1;
+          if (point[1])
+            point++;
+          break;
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+          complexity += 8;
+          break;
+        case '|':
+          complexity += 6;
+          break;
+        case '(':
+          complexity += 4;
+          break;
+        case '[':
+          complexity += 3;
+          break;
+        default:
+          complexity += 1;
+          break;
+      }
+
+  return complexity;
+}
+
+/**
+ * @brief Check whether a text Datum matches a compiled regular expression.
+ *
+ * @param[in]  regex  The compiled regular expression.
+ * @param[in]  value  The text Datum.
+ *
+ * @return 1 if the value matches, 0 otherwise.
+ */
+static int
+regexp_datum_matches_x (GRegex *regex, Datum value)
+{
+  text *string;
+
+  string = DatumGetTextPP (value);
+  return g_regex_match_full (regex, VARDATA_ANY (string),
+                             VARSIZE_ANY_EXHDR (string), 0, 0, NULL, NULL)
+         ? 1 : 0;
+}
+
+/**
+ * @brief Estimate the selectivity of regexp.
+ *
+ * If the expression is constant it is matched against the most common values
+ *  and the histogram of the column, like the built-in pattern operators do.
+ *
+ * @param[in]  req  The selectivity request.
+ *
+ * @return The selectivity.
+ */
+static Selectivity
+regexp_selectivity_x (SupportRequestSelectivity *req)
+{
+  VariableStatData vardata;
+  AttStatsSlot sslot;
+  GRegex *regex;
+  Selectivity selectivity;
+  char *pattern;
+
+  if (req->is_join || list_length (req->args) != 2)
+    return DEFAULT_MATCH_SEL;
+
+  pattern = planner_const_text_x (req->root, lsecond (req->args));
+  if (pattern == NULL)
+    return DEFAULT_MATCH_SEL;
+
+  regex = g_regex_new (pattern, 0, 0, NULL);
+  pfree (pattern);
+  // An invalid regular expression never matches.
+  if (regex == NULL)
+    return 0.0;
+
+  selectivity = DEFAULT_MATCH_SEL;
+  examine_variable (req->root, linitial (req->args), req->varRelid, &vardata);
+  if (HeapTupleIsValid (vardata.statsTuple)
+      && (vardata.atttype == TEXTOID || vardata.atttype == VARCHAROID)
+      && statistic_proc_security_check (&vardata, req->funcid))
+    {
+      double null_frac, mcv_total, mcv_matched, histogram_selectivity;
+      int index;
+
+      null_frac = ((Form_pg_statistic)
+                   GETSTRUCT (vardata.statsTuple))->stanullfrac;
+      mcv_total = 0;
+      mcv_matched = 0;
+      histogram_selectivity = DEFAULT_MATCH_SEL;
+
+      if (get_attstatsslot (&sslot, vardata.statsTuple, STATISTIC_KIND_MCV,
+                            InvalidOid,
+                            ATTSTATSSLOT_VALUES | ATTSTATSSLOT_NUMBERS))
+        {
+          for (index = 0; index < sslot.nvalues; index++)
+            {
+              mcv_total += sslot.numbers[index];
+              if (regexp_datum_matches_x (regex, sslot.values[index]))
+                mcv_matched += sslot.numbers[index];
+            }
+          free_attstatsslot (&sslot);
+        }
+
+      if (get_attstatsslot (&sslot, vardata.statsTuple,
+                            STATISTIC_KIND_HISTOGRAM, InvalidOid,
+                            ATTSTATSSLOT_VALUES))
+        {
+          // Too small histograms are not representative.
+          if (sslot.nvalues >= 10)
+            {
+              int matched = 0;
+
+              for (index = 0; index < sslot.nvalues; index++)
+                if (regexp_datum_matches_x (regex, sslot.values[index]))
+                  matched++;
+              histogram_selectivity = (double) matched / sslot.nvalues;
+            }
+          free_attstatsslot (&sslot);
+        }
+
+      selectivity = mcv_matched
+                    + histogram_selectivity * (1.0 - null_frac - mcv_total);
+    }
+  ReleaseVariableStats (vardata);
+  g_regex_unref (regex);
+
+  CLAMP_PROBABILITY (selectivity);
+  return selectivity;
+}
+
+/**
+ * @brief Estimate the cost of regexp per call.
+ *
+ * The regular expression is compiled on every call, so the cost depends on
+ *  its complexity and on the average width of the matched string.
+ *
+ * @param[in]  req  The cost request.
+ *
+ * @return 1 if the cost was estimated, 0 if the default cost should be used.
+ */
+static int
+regexp_cost_x (SupportRequestCost *req)
+{
+  Node *string_node;
+  char *pattern;
+  double complexity;
+  int32 width;
+
+  if (req->node == NULL || !IsA (req->node, FuncExpr)
+      || list_length (((FuncExpr *) req->node)->args) != 2)
+    return 0;
+
+  pattern = planner_const_text_x (req->root,
+                                  lsecond (((FuncExpr *) req->node)->args));
+  if (pattern == NULL)
+    return 0;
+
+  complexity = regexp_complexity_x (pattern);
+  pfree (pattern);
+
+  string_node = linitial (((FuncExpr *) req->node)->args);
+  width = get_typavgwidth (exprType (string_node), exprTypmod (string_node));
+
+  req->startup = 0;
+  req->per_tuple = cpu_operator_cost
+                   * (20 + 2 * complexity + complexity * width / 8);
+  return 1;
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_regexp_support);
+
+/**
+ * @brief Planner support function for regexp.
+ *
+ * Handles selectivity and cost requests of the planner.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_regexp_support (PG_FUNCTION_ARGS)
+{
+  Node *rawreq = (Node *) PG_GETARG_POINTER (0);
+  Node *ret = NULL;
+
+  if (IsA (rawreq, SupportRequestSelectivity))
+    {
+      SupportRequestSelectivity *req = (SupportRequestSelectivity *) rawreq;
+
+      req->selectivity = regexp_selectivity_x (req);
+      ret = (Node *) req;
+    }
+  else if (IsA (rawreq, SupportRequestCost))
+    {
+      SupportRequestCost *req = (SupportRequestCost *) rawreq;
+
+      if (regexp_cost_x (req))
+        ret = (Node *) req;
+    }
+
+  PG_RETURN_POINTER (ret);
+}
@@ -0,0 +1,218 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file schedule_worker.c
+ *
+ * @brief Background worker keeping the schedule due-queue up to date
+ *
+ * The worker connects to the database given by pg_gvm.schedule_database and
+ * calls pg_gvm_schedule_due_refresh every pg_gvm.schedule_naptime seconds,
+ * which applies the queued schedule changes and advances the schedules whose
+ * next occurrence has passed.
+ */
+
+#include "schedule_worker.h"
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+#include "access/xact.h"
+#include "executor/spi.h"
+#include "pgstat.h"
+#include "postmaster/bgworker.h"
+#include "storage/latch.h"
+#include "tcop/tcopprot.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/snapmgr.h"
+
+PGDLLEXPORT void
+pg_gvm_schedule_worker_main (Datum);
+
+/**
+ * @brief Database the worker connects to, the worker is off if empty.
+ */
+static char *schedule_database = NULL;
+
+/**
+ * @brief Seconds between two refreshes.
+ */
+static int schedule_naptime = 10;
+
+/**
+ * @brief Set by the SIGHUP handler.
+ */
+static volatile sig_atomic_t got_sighup = false;
+
+/**
+ * @brief Handle SIGHUP, reloading the configuration in the main loop.
+ *
+ * @param[in]  postgres_signal_arg  The signal.
+ */
+static void
+schedule_worker_sighup (SIGNAL_ARGS)
+{
+  int save_errno = errno;
+
+  got_sighup = true;
+  SetLatch (MyLatch);
+
+  errno = save_errno;
+}
+
+/**
+ * @brief Define the configuration variables of the schedule worker.
+ */
+void
+schedule_worker_define_gucs_x (void)
+{
+  DefineCustomStringVariable ("pg_gvm.schedule_database",
+                              "Database of the schedule worker.",
+                              "Only used if pg-gvm is loaded via"
+                              " shared_preload_libraries. The worker is not"
+                              " started if empty.",
+                              &schedule_database,
+                              "",
+                              PGC_POSTMASTER, 0,
+                              NULL, NULL, NULL);
+
+  DefineCustomIntVariable ("pg_gvm.schedule_naptime",
+                           "Time between two refreshes of the schedule"
+                           " due-queue.",
+                           NULL,
+                           &schedule_naptime,
+                           10, 1, 3600,
+                           PGC_SIGHUP, GUC_UNIT_S,
+                           NULL, NULL, NULL);
+}
+
+/**
+ * @brief Register the schedule worker if a database is configured.
+ *
+ * Must be called while the shared preload libraries are loaded.
+ */
+void
+schedule_worker_register_x (void)
+{
+  BackgroundWorker worker;
+
+  if (schedule_database == NULL || schedule_database[0] == '\0')
+    return;
+
+  memset (&worker, 0, sizeof (worker));
+  worker.bgw_flags = BGWORKER_SHMEM_ACCESS
+                     | BGWORKER_BACKEND_DATABASE_CONNECTION;
+  worker.bgw_start_time = BgWorkerStart_RecoveryFinished;
+  worker.bgw_restart_time = 60;
+  snprintf (worker.bgw_library_name, BGW_MAXLEN, "libpg-gvm");
+  snprintf (worker.bgw_function_name, BGW_MAXLEN,
+            "pg_gvm_schedule_worker_main");
+  snprintf (worker.bgw_name, BGW_MAXLEN, "pg-gvm schedule worker");
+  snprintf (worker.bgw_type, BGW_MAXLEN, "pg-gvm schedule worker");
+  worker.bgw_main_arg = (Datum) 0;
+  worker.bgw_notify_pid = 0;
+
+  RegisterBackgroundWorker (&worker);
+}
+
+/**
+ * @brief Refresh the due-queue once in a transaction of its own.
+ *
+ * The refresh is skipped if the extension is not installed in the database.
+ */
+static void
+schedule_worker_refresh (void)
+{
+  int ret;
+
+  SetCurrentStatementStartTimestamp ();
+  StartTransactionCommand ();
+  SPI_connect ();
+  PushActiveSnapshot (GetTransactionSnapshot ());
+  pgstat_report_activity (STATE_RUNNING, "refreshing schedule due-queue");
+
+  ret = SPI_execute ("SELECT n.nspname FROM pg_catalog.pg_extension e"
+                     " JOIN pg_catalog.pg_namespace n"
+                     " ON n.oid = e.extnamespace"
+                     " WHERE e.extname = 'pg-gvm'",
+                     true, 1);
+  if (ret != SPI_OK_SELECT)
+    elog (ERROR, "%s: cannot look up the extension: %d", __func__, ret);
+
+  if (SPI_processed > 0)
+    {
+      char *schema, *query;
+
+      schema = SPI_getvalue (SPI_tuptable->vals[0],
+                             SPI_tuptable->tupdesc, 1);
+      query = psprintf ("SELECT %s.pg_gvm_schedule_due_refresh ()",
+                        quote_identifier (schema));
+      ret = SPI_execute (query, false, 0);
+      if (ret != SPI_OK_SELECT)
+        elog (ERROR, "%s: cannot refresh the schedule due-queue: %d",
+              __func__, ret);
+      pfree (query);
+    }
+  else
+    elog (DEBUG1, "%s: pg-gvm is not installed in database %s",
+          __func__, schedule_database);
+
+  SPI_finish ();
+  PopActiveSnapshot ();
+  CommitTransactionCommand ();
+  pgstat_report_stat (false);
+  pgstat_report_activity (STATE_IDLE, NULL);
+}
+
+/**
+ * @brief Main function of the schedule worker.
+ *
+ * @param[in]  main_arg  Unused.
+ */
+void
+pg_gvm_schedule_worker_main (Datum main_arg)
+{
+  pqsignal (SIGHUP, schedule_worker_sighup);
+  pqsignal (SIGTERM, die);
+  BackgroundWorkerUnblockSignals ();
+
+  BackgroundWorkerInitializeConnection (schedule_database, NULL, 0);
+
+  elog (LOG, "pg-gvm schedule worker started in database %s",
+        schedule_database);
+
+  for (;;)
+    {
+      schedule_worker_refresh ();
+
+      (void) WaitLatch (MyLatch,
+                        WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+                        schedule_naptime * 1000L,
+                        PG_WAIT_EXTENSION);
+      ResetLatch (MyLatch);
+
+      CHECK_FOR_INTERRUPTS ();
+
+      if (got_sighup)
+        {
+          got_sighup = false;
+          ProcessConfigFile (PGC_SIGHUP);
+        }
+    }
+}
@@ -0,0 +1,359 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file stats.c
+ * @brief Function statistics in shared memory.
+ *
+ * The SQL functions measure their calls and add them to counters in shared
+ * memory, which are shown by the pg_gvm_stats view.  The statistics are only
+ * available if the library is loaded via shared_preload_libraries.
+ */
+
+#include "stats.h"
+
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/timestamp.h"
+#include "utils/tuplestore.h"
+
+/**
+ * @brief Counters of a function in shared memory.
+ */
+typedef struct stats_entry_x
+{
+  slock_t mutex;
+  int64 calls;
+  int64 total_time;
+  int64 max_time;
+  int64 parse_time;
+  int64 eval_time;
+  int64 bytes_parsed;
+  int64 iterations;
+  int64 cache_hits;
+  int64 cache_misses;
+} stats_entry_x;
+
+/**
+ * @brief Statistics shared between all backends.
+ */
+typedef struct stats_shared_x
+{
+  slock_t mutex;
+  TimestampTz reset_time;
+  stats_entry_x entries[STATS_FUNCTIONS_X];
+} stats_shared_x;
+
+/**
+ * @brief Names of the functions and which counters apply to them.
+ */
+static const struct
+{
+  const char *name;
+  bool has_iterations;
+  bool has_cache;
+} stats_functions[STATS_FUNCTIONS_X] = {
+  [STATS_HOSTS_CONTAINS_X] = {"hosts_contains", false, true},
+  [STATS_MAX_HOSTS_X] = {"max_hosts", false, true},
+  [STATS_REGEXP_X] = {"regexp", false, false},
+  [STATS_NEXT_TIME_ICAL_X] = {"next_time_ical", true, false},
+};
+
+/**
+ * @brief Whether calls are measured, set by pg_gvm.track_functions.
+ */
+static bool stats_track_functions = false;
+
+/**
+ * @brief Shared statistics, NULL if not available.
+ */
+static stats_shared_x *stats = NULL;
+
+/**
+ * @brief Define the configuration variables of the statistics.
+ */
+void
+stats_define_gucs_x (void)
+{
+  DefineCustomBoolVariable ("pg_gvm.track_functions",
+                            "Collects statistics of pg-gvm function calls.",
+                            "Only used if pg-gvm is loaded via"
+                            " shared_preload_libraries.  Off by default,"
+                            " like track_functions, because every call"
+                            " takes a spinlock of the shared statistics.",
+                            &stats_track_functions,
+                            false,
+                            PGC_SUSET, 0,
+                            NULL, NULL, NULL);
+}
+
+/**
+ * @brief Request the shared memory of the statistics.
+ */
+void
+stats_shmem_request_x (void)
+{
+  RequestAddinShmemSpace (MAXALIGN (sizeof (stats_shared_x)));
+}
+
+/**
+ * @brief Attach to or initialize the shared memory of the statistics.
+ */
+void
+stats_shmem_startup_x (void)
+{
+  bool found;
+  int index;
+
+  LWLockAcquire (AddinShmemInitLock, LW_EXCLUSIVE);
+
+  stats = ShmemInitStruct ("pg-gvm stats", sizeof (stats_shared_x), &found);
+  if (found == false)
+    {
+      memset (stats, 0, sizeof (stats_shared_x));
+      SpinLockInit (&stats->mutex);
+      stats->reset_time = GetCurrentTimestamp ();
+      for (index = 0; index < STATS_FUNCTIONS_X; index++)
+        SpinLockInit (&stats->entries[index].mutex);
+    }
+
+  LWLockRelease (AddinShmemInitLock);
+}
+
+/**
+ * @brief Get the microseconds since a time and set the time to now.
+ *
+ * @param[in,out]  since  The time, set to the current time.
+ *
+ * @return Microseconds since the given time.
+ */
+static int64
+stats_lap_x (instr_time *since)
+{
+  instr_time now;
+  int64 ret;
+
+  INSTR_TIME_SET_CURRENT (now);
+  ret = (int64) INSTR_TIME_GET_MICROSEC (now)
+        - (int64) INSTR_TIME_GET_MICROSEC (*since);
+  *since = now;
+  return ret;
+}
+
+/**
+ * @brief Start measuring a function call.
+ *
+ * @param[out]  call  The measurements of the call.
+ */
+void
+stats_begin_x (stats_call_x *call)
+{
+  memset (call, 0, sizeof (*call));
+  if (stats == NULL || stats_track_functions == false)
+    return;
+
+  call->active = 1;
+  INSTR_TIME_SET_CURRENT (call->start);
+  call->phase = call->start;
+}
+
+/**
+ * @brief End the parse phase of a function call.
+ *
+ * The time since the start of the call or of the previous parse phase is
+ *  counted as parse time.
+ *
+ * @param[in,out]  call   The measurements of the call.
+ * @param[in]      bytes  Number of bytes parsed.
+ */
+void
+stats_parsed_x (stats_call_x *call, int64 bytes)
+{
+  if (call->active == 0)
+    return;
+
+  call->parse_time += stats_lap_x (&call->phase);
+  call->bytes_parsed += bytes;
+}
+
+/**
+ * @brief End measuring a function call and add it to the statistics.
+ *
+ * The time since the end of the parse phase is counted as evaluation time.
+ *
+ * @param[in,out]  call      The measurements of the call.
+ * @param[in]      function  The function that was called.
+ */
+void
+stats_end_x (stats_call_x *call, stats_function_x function)
+{
+  stats_entry_x *entry;
+  int64 total_time;
+
+  if (call->active == 0)
+    return;
+
+  call->eval_time += stats_lap_x (&call->phase);
+  total_time = stats_lap_x (&call->start);
+
+  entry = &stats->entries[function];
+  SpinLockAcquire (&entry->mutex);
+  entry->calls++;
+  entry->total_time += total_time;
+  if (total_time > entry->max_time)
+    entry->max_time = total_time;
+  entry->parse_time += call->parse_time;
+  entry->eval_time += call->eval_time;
+  entry->bytes_parsed += call->bytes_parsed;
+  entry->iterations += call->iterations;
+  entry->cache_hits += call->cache_hits;
+  entry->cache_misses += call->cache_misses;
+  SpinLockRelease (&entry->mutex);
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_stats);
+
+/**
+ * @brief Return the statistics of all functions.
+ *
+ * This is a callback for a SQL function returning a set of rows.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_stats (PG_FUNCTION_ARGS)
+{
+  ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+  MemoryContext oldcontext;
+  Tuplestorestate *tupstore;
+  TupleDesc tupdesc;
+  TimestampTz reset_time;
+  int index;
+
+  if (rsinfo == NULL || !IsA (rsinfo, ReturnSetInfo)
+      || (rsinfo->allowedModes & SFRM_Materialize) == 0)
+    ereport (ERROR,
+             (errcode (ERRCODE_FEATURE_NOT_SUPPORTED),
+              errmsg ("materialize mode required, but it is not allowed"
+                      " in this context")));
+
+  oldcontext = MemoryContextSwitchTo
+                (rsinfo->econtext->ecxt_per_query_memory);
+  if (get_call_result_type (fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+    elog (ERROR, "return type must be a row type");
+  tupstore = tuplestore_begin_heap (true, false, work_mem);
+  rsinfo->returnMode = SFRM_Materialize;
+  rsinfo->setResult = tupstore;
+  rsinfo->setDesc = tupdesc;
+  MemoryContextSwitchTo (oldcontext);
+
+  if (stats == NULL)
+    return (Datum) 0;
+
+  SpinLockAcquire (&stats->mutex);
+  reset_time = stats->reset_time;
+  SpinLockRelease (&stats->mutex);
+
+  for (index = 0; index < STATS_FUNCTIONS_X; index++)
+    {
+      stats_entry_x entry;
+      Datum values[11];
+      bool nulls[11];
+
+      SpinLockAcquire (&stats->entries[index].mutex);
+      entry = stats->entries[index];
+      SpinLockRelease (&stats->entries[index].mutex);
+
+      memset (nulls, 0, sizeof (nulls));
+      values[0] = CStringGetTextDatum (stats_functions[index].name);
+      values[1] = Int64GetDatum (entry.calls);
+      values[2] = Float8GetDatum (entry.total_time / 1000.0);
+      values[3] = Float8GetDatum (entry.max_time / 1000.0);
+      values[4] = Float8GetDatum (entry.parse_time / 1000.0);
+      values[5] = Float8GetDatum (entry.eval_time / 1000.0);
+      values[6] = Int64GetDatum (entry.bytes_parsed);
+      values[7] = Int64GetDatum (entry.iterations);
+      nulls[7] = stats_functions[index].has_iterations == false;
+      values[8] = Int64GetDatum (entry.cache_hits);
+      nulls[8] = stats_functions[index].has_cache == false;
+      values[9] = Int64GetDatum (entry.cache_misses);
+      nulls[9] = stats_functions[index].has_cache == false;
+      values[10] = TimestampTzGetDatum (reset_time);
+
+      tuplestore_putvalues (tupstore, tupdesc, values, nulls);
+    }
+
+  return (Datum) 0;
+}
+
+/**
+ * @brief Define function for Postgres.
+ */
+PG_FUNCTION_INFO_V1 (sql_stats_reset);
+
+/**
+ * @brief Reset the statistics of all functions.
+ *
+ * This is a callback for a SQL function without arguments.
+ *
+ * @return Postgres Datum.
+ */
+Datum
+sql_stats_reset (PG_FUNCTION_ARGS)
+{
+  TimestampTz reset_time;
+  int index;
+
+  if (stats == NULL)
+    PG_RETURN_VOID ();
+
+  reset_time = GetCurrentTimestamp ();
+
+  for (index = 0; index < STATS_FUNCTIONS_X; index++)
+    {
+      stats_entry_x *entry = &stats->entries[index];
+
+      SpinLockAcquire (&entry->mutex);
+      entry->calls = 0;
+      entry->total_time = 0;
+      entry->max_time = 0;
+      entry->parse_time = 0;
+      entry->eval_time = 0;
+      entry->bytes_parsed = 0;
+      entry->iterations = 0;
+      entry->cache_hits = 0;
+      entry->cache_misses = 0;
+      SpinLockRelease (&entry->mutex);
+    }
+
+  SpinLockAcquire (&stats->mutex);
+  stats->reset_time = reset_time;
+  SpinLockRelease (&stats->mutex);
+
+  PG_RETURN_VOID ();
+}
@@ -0,0 +1,95 @@
+/* Copyright (C) 2026 Greenbone AG
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file text_arg.c
+ *
+ * @brief Reading text arguments without copying them
+ *
+ * Arguments are read with PG_GETARG_TEXT_PP, which only detoasts values
+ * that are compressed or stored out of line.  Short values keep their
+ * one byte header and are used in place, together with their length.
+ *
+ * The planner support functions read constant text arguments, so that
+ * they can estimate with the actual hosts string or pattern.
+ */
+
+#include "text_arg.h"
+
+#include "optimizer/optimizer.h"
+#include "utils/builtins.h"
+
+/**
+ * @brief Get the bytes of a text argument.
+ *
+ * @param[in]   fcinfo  Function call info of the calling SQL function.
+ * @param[in]   index   Index of the argument.
+ * @param[out]  arg     The bytes, empty if the argument is missing or NULL.
+ *
+ * @return 1 if the argument is given and not NULL, 0 otherwise.
+ */
+int
+text_arg_get_x (FunctionCallInfo fcinfo, int index, text_arg_x *arg)
+{
+  text *value;
+
+  if (PG_NARGS () <= index || PG_ARGISNULL (index))
+    {
+      arg->data = "";
+      arg->length = 0;
+      return 0;
+    }
+
+  value = PG_GETARG_TEXT_PP (index);
+  arg->data = VARDATA_ANY (value);
+  arg->length = VARSIZE_ANY_EXHDR (value);
+  return 1;
+}
+
+/**
+ * @brief Copy a text argument into a string, for engines that need one.
+ *
+ * @param[in]  arg  The argument.
+ *
+ * @return Freshly allocated string.
+ */
+char *
+text_arg_cstring_x (const text_arg_x *arg)
+{
+  return pnstrdup (arg->data, arg->length);
+}
+
+/**
+ * @brief Get the value of an argument as string if it is constant.
+ *
+ * @param[in]  root  Planner info, may be NULL.
+ * @param[in]  node  The argument expression.
+ *
+ * @return Freshly allocated string, or NULL if the value is not known.
+ */
+char *
+planner_const_text_x (PlannerInfo *root, Node *node)
+{
+  if (root)
+    node = estimate_expression_value (root, node);
+
+  if (IsA (node, Const) && ((Const *) node)->constisnull == false)
+    return TextDatumGetCString (((Const *) node)->constvalue);
+
+  return NULL;
+}
@@ -0,0 +1,50 @@
+-- Start transaction and plan the tests.
+BEGIN;
+
+-- IMPORTANT! See https://pgtap.org/documentation.html#iloveitwhenaplancomestogether
+SELECT plan(6);
+
+-- Run the tests.
+-- Test with no rows and NULL values
+SELECT is(hosts_count_distinct_agg(hosts), 0::bigint, 'No rows should count no hosts')
+FROM (VALUES (NULL::text)) AS targets (hosts) WHERE false;
+
+SELECT is(hosts_count_distinct_agg(hosts), 0::bigint, 'NULL hosts should count no hosts')
+FROM (VALUES (NULL::text)) AS targets (hosts);
+
+-- Test overlapping targets
+SELECT is(hosts_count_distinct_agg(hosts), 279::bigint, 'Overlapping hosts should be counted once')
+FROM (VALUES ('10.0.0.1-10.0.0.10, a.example'),
+             ('10.0.0.5-10.0.0.20, A.EXAMPLE, b'),
+             ('::1-::3, 10.0.1.0/24'),
+             ('invalid host string!')) AS targets (hosts);
+
+SELECT is(hosts_union_agg(hosts), '10.0.0.1-10.0.0.20, 10.0.1.1-10.0.1.254, ::1-::3, a.example, b',
+          'The union should be sorted and merged')
+FROM (VALUES ('10.0.0.1-10.0.0.10, a.example'),
+             ('10.0.0.5-10.0.0.20, A.EXAMPLE, b'),
+             ('::1-::3, 10.0.1.0/24')) AS targets (hosts);
+
+SELECT is(max_hosts(hosts_union_agg(hosts), ''), 30, 'The union should be a valid hosts string')
+FROM (VALUES ('192.168.0.1-10'), ('192.168.0.5-30')) AS targets (hosts);
+
+-- Test that the partial states of parallel workers are combined
+CREATE TABLE hosts_agg_test (hosts text);
+
+INSERT INTO hosts_agg_test
+  SELECT '192.168.' || (i % 100) || '.1-20, host-' || (i % 50)
+  FROM generate_series (0, 9999) AS i;
+
+ANALYZE hosts_agg_test;
+
+SET LOCAL parallel_setup_cost = 0;
+SET LOCAL parallel_tuple_cost = 0;
+SET LOCAL min_parallel_table_scan_size = 0;
+SET LOCAL max_parallel_workers_per_gather = 2;
+
+SELECT is(hosts_count_distinct_agg(hosts), 2050::bigint, 'Parallel aggregation should count each host once')
+FROM hosts_agg_test;
+
+-- Finish the tests and clean up.
+SELECT * FROM finish();
+ROLLBACK;
@@ -2,7 +2,7 @@
 BEGIN;
 
 -- IMPORTANT! See https://pgtap.org/documentation.html#iloveitwhenaplancomestogether
-SELECT plan(3);
+SELECT plan(9);
 
 -- Run the tests.
 -- Test with empty input
@@ -12,6 +12,22 @@ SELECT is(hosts_contains('192.168.123.1-192.168.123.20, 192.168.123.30', '192.16
 
 SELECT is(hosts_contains('192.168.123.1-192.168.123.20, 192.168.123.30',  '192.168.10.20'), false, 'Should return false');
 
+-- Test the inet variants, which keep the parsed hosts per call site
+SELECT is(hosts_contains('192.168.123.1-192.168.123.20, 192.168.123.30', '192.168.123.10'::inet), true, 'Address should be found');
+
+SELECT is(hosts_contains('2001:db8::/120', '2001:db8::1f'::inet), true, 'IPv6 address should be found');
+
+SELECT is(hosts_contains('2001:db8::/64', '2001:db8::ffff:1'::inet), false, 'An IPv6 network over max_hosts should contain no host and raise no error');
+
+SELECT is(hosts_contains('192.168.123.0/24', '192.168.123.10-20', '192.168.123.15'::inet), false, 'Excluded address should not be found');
+
+SELECT is(hosts_contains('192.168.123.0/24', NULL, '192.168.123.15'::inet), true, 'NULL exclude should exclude nothing');
+
+SELECT is(count (*), 2::bigint, 'Repeated calls should reuse the hosts')
+FROM (VALUES ('192.168.123.1'::inet), ('192.168.123.7'), ('192.168.123.21'))
+     AS hosts (host)
+WHERE hosts_contains('192.168.123.0/27', '192.168.123.2-10', host);
+
 -- Finish the tests and clean up.
 SELECT * FROM finish();
 ROLLBACK;
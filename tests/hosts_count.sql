@@ -0,0 +1,22 @@
+-- Start transaction and plan the tests.
+BEGIN;
+
+-- IMPORTANT! See https://pgtap.org/documentation.html#iloveitwhenaplancomestogether
+SELECT plan(6);
+
+-- Run the tests.
+SELECT is(hosts_count('192.168.0.0/24, 192.168.0.5', '192.168.0.10-19'), 244::numeric, 'IPv4 hosts should be counted once');
+
+SELECT is(hosts_count('invalid host string!'), NULL, 'Invalid hosts should give NULL');
+
+SELECT is(hosts_count('2001:db8::/64'), 18446744073709551614::numeric, 'An IPv6 /64 should be counted exactly');
+
+SELECT is(hosts_count('2001:db8::/48', '2001:db8::/64'), 1208907372870555465154560::numeric, 'Excluded IPv6 networks should be subtracted');
+
+SELECT is(hosts_count('::-ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff', '::5'), 340282366920938463463374607431768211455::numeric, 'The IPv6 address space should be counted without expanding it');
+
+SELECT is(hosts_count('2001:db8::/64', '2001:db8::/64'), 0::numeric, 'A network excluded from itself should have no hosts');
+
+-- Finish the tests and clean up.
+SELECT * FROM finish();
+ROLLBACK;
@@ -0,0 +1,31 @@
+-- Start transaction and plan the tests.
+BEGIN;
+
+-- IMPORTANT! See https://pgtap.org/documentation.html#iloveitwhenaplancomestogether
+SELECT plan(5);
+
+-- Run the tests.
+SELECT is_empty($$ SELECT * FROM hosts_ranges(NULL, NULL) $$, 'NULL hosts should have no ranges');
+
+SELECT is_empty($$ SELECT * FROM hosts_ranges('invalid host string!', NULL) $$, 'Invalid hosts should have no ranges');
+
+SELECT results_eq(
+  $$ SELECT lo, hi FROM hosts_ranges('192.168.0.1-20, 192.168.0.10-30, a.example, 10.0.0.1', NULL) $$,
+  $$ VALUES ('10.0.0.1'::inet, '10.0.0.1'::inet), ('192.168.0.1', '192.168.0.30') $$,
+  'Ranges should be merged and sorted without hostnames');
+
+SELECT results_eq(
+  $$ SELECT lo, hi FROM hosts_ranges('192.168.0.0/24, 2001:db8::1-2001:db8::ff', '192.168.0.10-20, 2001:db8::10') $$,
+  $$ VALUES ('192.168.0.1'::inet, '192.168.0.9'::inet), ('192.168.0.21', '192.168.0.254'),
+            ('2001:db8::1', '2001:db8::f'), ('2001:db8::11', '2001:db8::ff') $$,
+  'Excluded hosts should split the ranges');
+
+SELECT is(count(*), 2::bigint, 'The ranges should give the same hosts as hosts_contains')
+FROM (VALUES ('192.168.0.1'::inet), ('192.168.0.15'), ('192.168.0.30'), ('10.0.0.1'))
+     AS results (host)
+JOIN hosts_ranges('192.168.0.1-30', '192.168.0.10-20') AS r
+  ON host BETWEEN r.lo AND r.hi;
+
+-- Finish the tests and clean up.
+SELECT * FROM finish();
+ROLLBACK;
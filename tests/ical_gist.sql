@@ -0,0 +1,104 @@
+-- Start transaction and plan the tests.
+BEGIN;
+
+-- IMPORTANT! See https://pgtap.org/documentation.html#iloveitwhenaplancomestogether
+SELECT plan(7);
+
+-- Function to get the plan of a query as a single text.
+CREATE OR REPLACE FUNCTION explain_gist_test_plan (text)
+RETURNS text AS $$
+DECLARE
+    line text;
+    result text := '';
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (COSTS OFF) ' || $1 LOOP
+      result := result || line || E'\n';
+    END LOOP;
+    RETURN result;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TEMPORARY TABLE gist_test_schedules
+  (id integer PRIMARY KEY,
+   icalendar text);
+
+CREATE OR REPLACE FUNCTION gist_test_ical (text, text)
+RETURNS text AS $$
+  SELECT 'BEGIN:VCALENDAR' || E'\n'
+         || 'VERSION:2.0' || E'\n'
+         || 'BEGIN:VEVENT' || E'\n'
+         || 'DTSTART:' || $1 || E'\n'
+         || 'DURATION:PT0S' || E'\n'
+         || coalesce ('RRULE:' || $2 || E'\n', '')
+         || 'UID:' || md5 ($1 || coalesce ($2, '')) || E'\n'
+         || 'END:VEVENT' || E'\n'
+         || 'END:VCALENDAR';
+$$ LANGUAGE SQL IMMUTABLE;
+
+-- Daily since 2010, once in 2015, three times weekly from 2020-01-06,
+--  daily until 2012 and many more schedules ending before 2013.
+INSERT INTO gist_test_schedules
+  VALUES (1, gist_test_ical ('20100101T030700Z', 'FREQ=DAILY')),
+         (2, gist_test_ical ('20150601T120000Z', NULL)),
+         (3, gist_test_ical ('20200106T090000Z', 'FREQ=WEEKLY;COUNT=3')),
+         (4, gist_test_ical ('20100101T030700Z',
+                             'FREQ=DAILY;UNTIL=20120101T000000Z'));
+INSERT INTO gist_test_schedules
+  SELECT i, gist_test_ical (to_char (date '2011-01-01' + i % 365,
+                                     'YYYYMMDD') || 'T100000Z',
+                            'FREQ=WEEKLY;COUNT=10')
+  FROM generate_series (5, 1000) AS i;
+
+CREATE INDEX gist_test_schedules_idx
+  ON gist_test_schedules USING gist (icalendar gist_ical_ops);
+ANALYZE gist_test_schedules;
+
+SELECT is (ical_span (icalendar)::text, '(1433160000,1433160000,0)',
+           'Span of a single occurrence')
+FROM gist_test_schedules WHERE id = 2;
+
+SELECT is (ical_span (icalendar)::text, '(1578301200,1579510800,608400)',
+           'Span of a COUNT should end at the last occurrence')
+FROM gist_test_schedules WHERE id = 3;
+
+SELECT is (ical_span (icalendar)::text, '(1262315220,infinity,90000)',
+           'Span of an endless daily rule')
+FROM gist_test_schedules WHERE id = 1;
+
+SET LOCAL enable_seqscan = off;
+
+SELECT matches (explain_gist_test_plan ('SELECT id FROM gist_test_schedules'
+                                        || ' WHERE icalendar && tstzrange'
+                                        || ' (''2020-01-06 00:00+00'','
+                                        || ' ''2020-01-07 00:00+00'')'),
+                'gist_test_schedules_idx',
+                'Window query should use the index');
+
+SELECT results_eq ($$SELECT id FROM gist_test_schedules
+                     WHERE icalendar && tstzrange ('2020-01-06 00:00+00',
+                                                   '2020-01-07 00:00+00')
+                     ORDER BY id$$,
+                   ARRAY[1, 3],
+                   'Daily and weekly schedules should occur on 2020-01-06');
+
+SELECT results_eq ($$SELECT id FROM gist_test_schedules
+                     WHERE icalendar && tstzrange ('2015-06-01 00:00+00',
+                                                   '2015-06-02 00:00+00')
+                     ORDER BY id$$,
+                   ARRAY[1, 2],
+                   'Daily and single schedules should occur on 2015-06-01');
+
+SELECT results_eq ($$SELECT id FROM gist_test_schedules
+                     WHERE icalendar && tstzrange ('2011-03-01 00:00+00',
+                                                   '2011-03-08 00:00+00')
+                     ORDER BY id$$,
+                   $$SELECT id FROM gist_test_schedules
+                     WHERE ical_occurs_in (icalendar,
+                                           tstzrange ('2011-03-01 00:00+00',
+                                                      '2011-03-08 00:00+00'))
+                     ORDER BY id$$,
+                   'Index should find the same schedules as the operator');
+
+-- Finish the tests and clean up.
+SELECT * FROM finish();
+ROLLBACK;
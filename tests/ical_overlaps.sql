@@ -0,0 +1,79 @@
+-- Start transaction and plan the tests.
+BEGIN;
+
+-- IMPORTANT! See https://pgtap.org/documentation.html#iloveitwhenaplancomestogether
+SELECT plan(8);
+
+CREATE OR REPLACE FUNCTION overlaps_test_ical (text, text)
+RETURNS text AS $$
+  SELECT 'BEGIN:VCALENDAR' || E'\n'
+         || 'VERSION:2.0' || E'\n'
+         || 'BEGIN:VEVENT' || E'\n'
+         || 'DTSTART:' || $1 || E'\n'
+         || 'DURATION:PT0S' || E'\n'
+         || coalesce ('RRULE:' || $2 || E'\n', '')
+         || 'UID:' || md5 ($1 || coalesce ($2, '')) || E'\n'
+         || 'END:VEVENT' || E'\n'
+         || 'END:VCALENDAR';
+$$ LANGUAGE SQL IMMUTABLE;
+
+-- Daily at 10:00 for an hour, daily at 10:30 and 12:00 for ten minutes and
+--  once at 10:05 on the second day for a minute, over three days from
+--  2025-01-01 00:00 UTC.
+CREATE TEMPORARY TABLE overlaps_test_result AS
+  SELECT * FROM ical_overlaps
+    (ARRAY[overlaps_test_ical ('20250101T100000Z', 'FREQ=DAILY'),
+           overlaps_test_ical ('20250101T103000Z', 'FREQ=DAILY'),
+           overlaps_test_ical ('20250101T120000Z', 'FREQ=DAILY'),
+           overlaps_test_ical ('20250102T100500Z', NULL)],
+     ARRAY[3600, 600, 600, 60],
+     1735689600, 1735689600 + 3 * 86400);
+
+SELECT is (first_schedules, ARRAY[1, 1], 'First schedules of the conflicts')
+FROM overlaps_test_result;
+
+SELECT is (second_schedules, ARRAY[2, 4], 'Second schedules of the conflicts')
+FROM overlaps_test_result;
+
+SELECT is (peak, 2, 'Peak concurrency')
+FROM overlaps_test_result;
+
+SELECT is (peak_time, 1735727400::bigint, 'Peak is first reached at 10:30')
+FROM overlaps_test_result;
+
+-- An occurrence that started before the window still runs in it.
+SELECT is ((ical_overlaps
+              (ARRAY[overlaps_test_ical ('20241231T230000Z', NULL),
+                     overlaps_test_ical ('20250101T003000Z', NULL)],
+               ARRAY[7200, 60],
+               1735689600, 1735689600 + 86400)).second_schedules,
+           ARRAY[2],
+           'Occurrences before the window should be included');
+
+-- NULL and invalid schedules have no occurrences.
+SELECT is ((ical_overlaps
+              (ARRAY[overlaps_test_ical ('20250101T100000Z', 'FREQ=DAILY'),
+                     NULL,
+                     overlaps_test_ical ('20250101T100000Z', 'FREQ=DAILY')],
+               ARRAY[3600, 3600, 3600],
+               1735689600, 1735689600 + 86400)).second_schedules,
+           ARRAY[3],
+           'NULL schedules should be skipped');
+
+SELECT is ((ical_overlaps
+              (ARRAY[overlaps_test_ical ('20250101T100000Z', 'FREQ=DAILY'),
+                     'not a calendar',
+                     overlaps_test_ical ('20250101T100000Z', 'FREQ=DAILY')],
+               ARRAY[3600, 3600, 3600],
+               1735689600, 1735689600 + 86400)).second_schedules,
+           ARRAY[3],
+           'Invalid schedules should be skipped');
+
+SELECT throws_ok ($$SELECT ical_overlaps (ARRAY['', ''], ARRAY[1],
+                                          0, 1)$$,
+                  '2202E', NULL,
+                  'Schedules and durations must have the same length');
+
+-- Finish the tests and clean up.
+SELECT * FROM finish();
+ROLLBACK;
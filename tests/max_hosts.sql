@@ -2,13 +2,31 @@
 BEGIN;
 
 -- IMPORTANT! See https://pgtap.org/documentation.html#iloveitwhenaplancomestogether
-SELECT plan(2);
+SELECT plan(11);
 
 -- Run the tests.
 -- Test with empty input
 SELECT is(max_hosts('192.168.123.1-192.168.123.20, 192.168.123.30-192.168.123.34', ''), 25, 'Value should be 25');
 SELECT is(max_hosts('192.168.123.1-192.168.123.20, 192.168.123.30-192.168.123.34', '192.168.123.10'), 24, 'Value should be 24');
 
+-- Test CIDR blocks, duplicates, hostnames and IPv6 ranges
+SELECT is(max_hosts('192.168.123.0/24, 192.168.123.10-20, Example.com, example.com', '192.168.123.0/28'), 241, 'Value should be 241');
+SELECT is(max_hosts('2001:db8::1-ff, 2001:db8::/120', '2001:db8::10-2001:db8::1f'), 239, 'Value should be 239');
+SELECT is(max_hosts('192.168.123.1, not a host', ''), -1, 'Invalid hosts should return -1');
+SELECT is(max_hosts('192.168.123.1', 'bad!'), -1, 'Invalid excluded hosts should return -1');
+
+-- Test a repeated count, which may come from the host count cache
+SELECT is(max_hosts('192.168.123.1-192.168.123.20, 192.168.123.30-192.168.123.34', '192.168.123.10'), 24, 'Repeated value should be 24');
+
+SELECT ok((SELECT hits >= 0 AND misses >= 0 AND entries <= size FROM pg_gvm_host_cache_stats ()), 'Cache counters should be consistent');
+
+-- Test the range limit, which is checked while the hosts are parsed
+SET LOCAL pg_gvm.host_range_limit = 2;
+SELECT throws_ok ($$SELECT max_hosts ('192.168.125.1, 192.168.125.3, 192.168.125.5', '')$$, '54000', NULL, 'Ranges over the limit should be rejected');
+SELECT is(max_hosts('192.168.123.1-192.168.123.20', ''), 20, 'Hosts within the limit should be counted');
+SELECT is(max_hosts('10.0.0.0/8', ''), -1, 'Too many hosts should return -1');
+RESET pg_gvm.host_range_limit;
+
 -- Finish the tests and clean up.
 SELECT * FROM finish();
 ROLLBACK;
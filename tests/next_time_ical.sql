@@ -2,7 +2,7 @@
 BEGIN;
 
 -- IMPORTANT! See https://pgtap.org/documentation.html#iloveitwhenaplancomestogether
-SELECT plan(10);
+SELECT plan(11);
 
 -- Function to calculate the test timestamps based on current time
 --  PostgreSQL internal date-time functions.
@@ -176,6 +176,23 @@ END:VCALENDAR', EXTRACT (EPOCH from now())::bigint, 'Europe/Berlin', -1),
 next_test_time (-1, now ()),
 'Calculation was wrong');
 
+-- Test the iteration limit with a daily rule started long ago
+SET LOCAL pg_gvm.ical_max_iterations = 100;
+SELECT throws_ok (
+$$SELECT next_time_ical ('BEGIN:VCALENDAR
+VERSION:2.0
+BEGIN:VEVENT
+DTSTART:20100101T030700Z
+DURATION:PT0S
+RRULE:FREQ=DAILY
+UID:2d7bb4e0-5bd2-4ba4-9c16-1f8d4fd7d3ab
+END:VEVENT
+END:VCALENDAR', 1600000000::bigint, 'UTC')$$,
+'54000',
+'iCalendar recurrence needs more than 100 iterations',
+'Recurrence should stop at the iteration limit');
+RESET pg_gvm.ical_max_iterations;
+
 -- Finish the tests and clean up.
 SELECT * FROM finish();
 
@@ -0,0 +1,109 @@
+-- Start transaction and plan the tests.
+BEGIN;
+
+-- IMPORTANT! See https://pgtap.org/documentation.html#iloveitwhenaplancomestogether
+SELECT plan(14);
+
+-- Function to get the plan of a query as a single text.
+CREATE OR REPLACE FUNCTION explain_test_plan (text)
+RETURNS text AS $$
+DECLARE
+    line text;
+    result text := '';
+BEGIN
+    FOR line IN EXECUTE 'EXPLAIN (COSTS OFF) ' || $1 LOOP
+      result := result || line || E'\n';
+    END LOOP;
+    RETURN result;
+END;
+$$ LANGUAGE plpgsql;
+
+-- Run the tests.
+-- Test the declared function properties
+SELECT volatility_is ('regexp', ARRAY['text', 'text'], 'immutable');
+SELECT volatility_is ('hosts_contains', ARRAY['text', 'text'], 'stable');
+SELECT volatility_is ('max_hosts', ARRAY['text', 'text'], 'stable');
+SELECT volatility_is ('next_time_ical', ARRAY['text', 'bigint', 'text'],
+                      'stable');
+SELECT volatility_is ('next_time_ical',
+                      ARRAY['text', 'bigint', 'text', 'integer'], 'stable');
+
+SELECT is ((SELECT count (*)::integer FROM pg_proc
+            WHERE proname IN ('regexp', 'hosts_contains', 'max_hosts',
+                              'next_time_ical')
+              AND proparallel != 's'),
+           0,
+           'All functions should be parallel safe');
+
+SELECT is ((SELECT count (*)::integer FROM pg_proc
+            WHERE proname IN ('regexp', 'hosts_contains', 'max_hosts',
+                              'next_time_ical')
+              AND procost <= 1),
+           0,
+           'All functions should have a cost set');
+
+-- Test the plans chosen for a table large enough for parallel scans
+CREATE TABLE parallel_test_hosts (host text, target text, ical text);
+
+INSERT INTO parallel_test_hosts
+  SELECT '192.168.' || (i / 250) || '.' || (i % 250 + 1),
+         '192.168.0.1-192.168.0.20, 192.168.1.0/24',
+         'BEGIN:VCALENDAR
+BEGIN:VEVENT
+DTSTART:20200101T120000Z
+RRULE:FREQ=DAILY
+END:VEVENT
+END:VCALENDAR'
+  FROM generate_series (0, 9999) AS i;
+
+ANALYZE parallel_test_hosts;
+
+SET LOCAL parallel_setup_cost = 0;
+SET LOCAL parallel_tuple_cost = 0;
+SET LOCAL min_parallel_table_scan_size = 0;
+SET LOCAL max_parallel_workers_per_gather = 2;
+
+SELECT matches (explain_test_plan ('SELECT * FROM parallel_test_hosts'
+                                   ' WHERE regexp (host, ''^192\.168\.1\.'')'),
+                'Gather',
+                'regexp should allow a parallel plan');
+
+SELECT matches (explain_test_plan ('SELECT * FROM parallel_test_hosts'
+                                   ' WHERE hosts_contains (target, host)'),
+                'Gather',
+                'hosts_contains should allow a parallel plan');
+
+SELECT matches (explain_test_plan ('SELECT * FROM parallel_test_hosts'
+                                   ' WHERE max_hosts (target, host) > 1'),
+                'Gather',
+                'max_hosts should allow a parallel plan');
+
+SELECT matches (explain_test_plan ('SELECT * FROM parallel_test_hosts'
+                                   ' WHERE next_time_ical (ical, 0, ''UTC'')'
+                                   '       > 0'),
+                'Gather',
+                'next_time_ical should allow a parallel plan');
+
+-- Test constant folding of immutable functions
+SELECT doesnt_match (explain_test_plan ('SELECT * FROM parallel_test_hosts'
+                                        ' WHERE regexp (''abc'', ''^a'')'),
+                     'regexp',
+                     'regexp with constant arguments should be folded');
+
+-- Test that the results are the same in parallel workers
+SELECT is ((SELECT count (*)::integer FROM parallel_test_hosts
+            WHERE hosts_contains (target, host)),
+           270,
+           'hosts_contains should give the same results in parallel');
+
+SELECT is ((SELECT count (*)::integer FROM parallel_test_hosts
+            WHERE regexp (host, '^192\.168\.1\.')),
+           250,
+           'regexp should give the same results in parallel');
+
+-- Finish the tests and clean up.
+SELECT * FROM finish();
+
+DROP FUNCTION explain_test_plan (text);
+
+ROLLBACK;
@@ -0,0 +1,148 @@
+-- Start transaction and plan the tests.
+BEGIN;
+
+-- IMPORTANT! See https://pgtap.org/documentation.html#iloveitwhenaplancomestogether
+SELECT plan(13);
+
+-- Function to get an estimate of the top plan node of a query.
+CREATE OR REPLACE FUNCTION estimate_test_plan (text, text)
+RETURNS double precision AS $$
+DECLARE
+    result json;
+BEGIN
+    EXECUTE 'EXPLAIN (FORMAT JSON) ' || $1 INTO result;
+    RETURN (result -> 0 -> 'Plan' ->> $2)::double precision;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TABLE support_test_hosts (host text);
+
+INSERT INTO support_test_hosts
+  SELECT '192.168.' || (i / 250) || '.' || (i % 250 + 1)
+  FROM generate_series (0, 9999) AS i;
+
+ANALYZE support_test_hosts;
+
+SET LOCAL max_parallel_workers_per_gather = 0;
+
+-- Run the tests.
+-- Test the support functions are attached
+SELECT isnt ((SELECT prosupport FROM pg_proc
+              WHERE oid = 'hosts_contains(text,text)'::regprocedure),
+             0::regproc,
+             'hosts_contains should have a support function');
+
+SELECT is ((SELECT count (*)::integer FROM pg_proc
+            WHERE proname = 'hosts_contains' AND prosupport = 0),
+           0,
+           'All variants of hosts_contains should have a support function');
+
+SELECT isnt ((SELECT prosupport FROM pg_proc WHERE proname = 'regexp'),
+             0::regproc,
+             'regexp should have a support function');
+
+-- Test the row estimates
+SELECT cmp_ok (estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                   ' WHERE hosts_contains'
+                                   '        (''192.168.0.1-192.168.0.20'','
+                                   '         host)',
+                                   'Plan Rows'),
+               '<=', 100::double precision,
+               'hosts_contains estimate should use the number of hosts');
+
+SELECT cmp_ok (estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                   ' WHERE hosts_contains'
+                                   '        (''192.168.0.0/16'', host)',
+                                   'Plan Rows'),
+               '>=', 5000::double precision,
+               'hosts_contains estimate should grow with the number of hosts');
+
+SELECT is (estimate_test_plan ('SELECT * FROM support_test_hosts'
+                               ' WHERE hosts_contains (''bad!'', host)',
+                               'Plan Rows'),
+           1::double precision,
+           'hosts_contains estimate should be minimal for invalid hosts');
+
+SELECT cmp_ok (estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                   ' WHERE hosts_contains'
+                                   '        (''192.168.0.1-192.168.0.100'','
+                                   '         ''192.168.0.1-192.168.0.90'','
+                                   '         host::inet)',
+                                   'Plan Rows'),
+               '<', estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                        ' WHERE hosts_contains'
+                                        '        (''192.168.0.1-192.168.0.100'','
+                                        '         host::inet)',
+                                        'Plan Rows'),
+               'hosts_contains estimate should leave out excluded hosts');
+
+SELECT cmp_ok (estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                   ' WHERE regexp (host,'
+                                   '               ''^192\.168\.1\.'')',
+                                   'Plan Rows'),
+               '<=', 1000::double precision,
+               'regexp estimate should use the column statistics');
+
+SELECT cmp_ok (estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                   ' WHERE regexp (host, ''^10\.'')',
+                                   'Plan Rows'),
+               '<', 10::double precision,
+               'regexp estimate should be small if nothing matches');
+
+SELECT cmp_ok (estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                   ' WHERE regexp (host, ''[a-z'')',
+                                   'Plan Rows'),
+               '<', 10::double precision,
+               'regexp estimate should be small for invalid expressions');
+
+-- Test the cost estimates
+SELECT cmp_ok (estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                   ' WHERE regexp (host,'
+                                   '               ''^((a|b)*(c|d)+)\1$'')',
+                                   'Total Cost'),
+               '>',
+               estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                   ' WHERE regexp (host, ''abc'')',
+                                   'Total Cost'),
+               'regexp cost should grow with the complexity');
+
+CREATE TEMPORARY TABLE support_test_targets (hosts text);
+
+INSERT INTO support_test_targets
+  SELECT string_agg ('10.0.' || (i / 250) || '.' || (i % 250 + 1), ', ')
+  FROM generate_series (0, 999) AS i;
+
+SELECT cmp_ok (estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                   ' WHERE hosts_contains ('
+                                   || quote_literal ((SELECT hosts
+                                                      FROM support_test_targets))
+                                   || ', host::inet)',
+                                   'Total Cost'),
+               '>',
+               estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                   ' WHERE hosts_contains (''10.0.0.0/16'','
+                                   '                       host::inet)',
+                                   'Total Cost'),
+               'hosts_contains cost should grow with the ranges');
+
+SELECT cmp_ok (estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                   ' WHERE hosts_contains ('
+                                   || quote_literal ((SELECT hosts || ', bad!'
+                                                      FROM support_test_targets))
+                                   || ', host::inet)',
+                                   'Total Cost'),
+               '<',
+               estimate_test_plan ('SELECT * FROM support_test_hosts'
+                                   ' WHERE hosts_contains ('
+                                   || quote_literal ((SELECT hosts
+                                                      FROM support_test_targets))
+                                   || ', host::inet)',
+                                   'Total Cost'),
+               'hosts_contains cost should be low for invalid hosts');
+
+-- Finish the tests and clean up.
+SELECT * FROM finish();
+
+DROP FUNCTION estimate_test_plan (text, text);
+
+ROLLBACK;
@@ -0,0 +1,62 @@
+-- Start transaction and plan the tests.
+BEGIN;
+
+-- IMPORTANT! See https://pgtap.org/documentation.html#iloveitwhenaplancomestogether
+SELECT plan(8);
+
+-- Schedules like the ones of gvmd, queued by the trigger.
+CREATE TEMPORARY TABLE due_test_schedules
+  (id integer PRIMARY KEY,
+   icalendar text,
+   timezone text);
+
+CREATE TRIGGER due_test_schedules_queue
+  AFTER INSERT OR UPDATE OR DELETE ON due_test_schedules
+  FOR EACH ROW EXECUTE PROCEDURE
+  pg_gvm_schedule_queue_trigger ('id', 'icalendar', 'timezone');
+
+-- Start with the due-queue of this test only.
+DELETE FROM pg_gvm_schedule_due;
+DELETE FROM pg_gvm_schedule_queue;
+
+-- Daily at 03:07 UTC since 2010.
+INSERT INTO due_test_schedules VALUES (1, 'BEGIN:VCALENDAR
+VERSION:2.0
+BEGIN:VEVENT
+DTSTART:20100101T030700Z
+DURATION:PT0S
+RRULE:FREQ=DAILY
+UID:5c2aa2b2-6a0e-4a61-8b7e-6b1fbbd0c1d4
+END:VEVENT
+END:VCALENDAR', 'UTC');
+
+SELECT is ((SELECT count (*)::integer FROM pg_gvm_schedule_queue), 1,
+           'Insert should be queued');
+
+-- Reference time 2020-09-13 12:26:40 UTC.
+SELECT is (pg_gvm_schedule_due_refresh (1600000000), 1,
+           'Queued schedule should be refreshed');
+
+SELECT is ((SELECT next_time FROM pg_gvm_schedule_due WHERE schedule_id = 1),
+           1600052820::bigint, 'Next time should be 2020-09-14 03:07 UTC');
+
+SELECT is (pg_gvm_schedule_due_refresh (1600000000), 0,
+           'Nothing should be refreshed before the occurrence passed');
+
+-- 2020-09-14 12:00 UTC, after the occurrence.
+SELECT is (pg_gvm_schedule_due_refresh (1600084800), 1,
+           'Passed occurrence should be refreshed');
+
+SELECT is ((SELECT next_time FROM pg_gvm_schedule_due WHERE schedule_id = 1),
+           1600139220::bigint, 'Next time should be 2020-09-15 03:07 UTC');
+
+DELETE FROM due_test_schedules WHERE id = 1;
+SELECT lives_ok ('SELECT pg_gvm_schedule_due_refresh (1600084800)',
+                 'Deletion should be refreshed');
+
+SELECT is_empty ('SELECT * FROM pg_gvm_schedule_due',
+                 'Deleted schedule should be removed');
+
+-- Finish the tests and clean up.
+SELECT * FROM finish();
+ROLLBACK;
@@ -0,0 +1,53 @@
+-- Start transaction and plan the tests.
+BEGIN;
+
+-- IMPORTANT! See https://pgtap.org/documentation.html#iloveitwhenaplancomestogether
+SELECT plan(8);
+
+-- The statistics are off by default
+SET LOCAL pg_gvm.track_functions = on;
+
+-- Run the tests.
+SELECT has_view ('pg_gvm_stats');
+
+SELECT has_function ('pg_gvm_stats_reset');
+
+SELECT is ((SELECT proparallel FROM pg_proc
+            WHERE oid = 'pg_gvm_stats_reset ()'::regprocedure),
+           'r'::"char",
+           'pg_gvm_stats_reset writes shared memory, so it is parallel restricted');
+
+-- The statistics are empty unless the library is preloaded
+SELECT ok ((SELECT count (*) FROM pg_gvm_stats) IN (0, 4),
+           'Should have statistics of all functions or none');
+
+SELECT is (regexp ('abc', '^[a-z]+$'), true, 'Should match');
+
+SELECT ok (NOT EXISTS (SELECT * FROM pg_gvm_stats
+                       WHERE funcname = 'regexp'
+                         AND (calls = 0
+                              OR parse_time + eval_time > total_time + 0.01
+                              OR iterations IS NOT NULL
+                              OR cache_hits IS NOT NULL)),
+           'Statistics of regexp should be consistent');
+
+SELECT pg_gvm_stats_reset ();
+
+SELECT is ((SELECT count (*)::integer
+            FROM (VALUES ('192.168.0.1'), ('192.168.0.2'), ('192.168.0.3'))
+                 AS hosts (host)
+            WHERE hosts_contains ('192.168.0.0/24', host)),
+           3,
+           'Should contain all hosts');
+
+-- The hosts are parsed once for the call site and found in the cache after
+SELECT ok (NOT EXISTS (SELECT * FROM pg_gvm_stats
+                       WHERE funcname = 'hosts_contains'
+                         AND (calls < 3
+                              OR cache_misses < 1
+                              OR cache_hits < 2)),
+           'Cache counters of hosts_contains should move');
+
+-- Finish the tests and clean up.
+SELECT * FROM finish();
+ROLLBACK;